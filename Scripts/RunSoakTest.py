@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""Multi-process soak test: one headless server and N -nullrhi clients on this machine.
+
+The server runs AClimbingSoakGameMode, waits for every client, soaks for --seconds and writes
+Saved/Profiling/ClimbingSoak.csv (per-connection bandwidth, corrections and server frame time).
+Clients play a seeded random script, or --script for a recorded one (see AClimbingSoakPlayerController).
+
+Packaged Linux build:
+    Scripts/RunSoakTest.py --server Binaries/Linux/IslandAdventureGameServer --client Binaries/Linux/IslandAdventureGame --clients 16
+Editor build:
+    Scripts/RunSoakTest.py --editor /path/to/UnrealEditor-Cmd --clients 8 --lag 80 --loss 2
+"""
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import time
+
+PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+PROJECT_FILE = os.path.join(PROJECT_DIR, "IslandAdventureGame.uproject")
+GAME_MODE = "/Script/IslandAdventureGame.ClimbingSoakGameMode"
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    binaries = parser.add_mutually_exclusive_group(required=True)
+    binaries.add_argument("--editor", help="UnrealEditor-Cmd, runs the server and clients from the project")
+    binaries.add_argument("--server", help="packaged dedicated server binary, use with --client")
+    parser.add_argument("--client", help="packaged client binary")
+    parser.add_argument("--map", default="/Game/ThirdPerson/Maps/ThirdPersonMap")
+    parser.add_argument("--clients", type=int, default=8)
+    parser.add_argument("--seconds", type=float, default=300)
+    parser.add_argument("--port", type=int, default=7777)
+    parser.add_argument("--lag", type=int, default=0, help="simulated packet lag in ms on every client")
+    parser.add_argument("--lag-variance", type=int, default=0, help="random extra lag in ms")
+    parser.add_argument("--loss", type=int, default=0, help="simulated packet loss in percent on every client")
+    parser.add_argument("--script", help="recorded soak script played by every client instead of random play")
+    parser.add_argument("--seed", type=int, default=1, help="first client's random seed, each client adds its index")
+    parser.add_argument("--logs", default=os.path.join(PROJECT_DIR, "Saved", "Logs", "Soak"))
+    parser.add_argument("--report", default=os.path.join(PROJECT_DIR, "Saved", "Profiling", "ClimbingSoak.csv"),
+                        help="where the server writes its report, packaged builds write under their own Saved directory")
+    args = parser.parse_args()
+    if args.server and not args.client:
+        parser.error("--server needs --client")
+    return args
+
+
+def base_command(args, binary_for_server):
+    if args.editor:
+        return [args.editor, PROJECT_FILE]
+    return [args.server if binary_for_server else args.client]
+
+
+def launch_server(args):
+    url = f"{args.map}?game={GAME_MODE}?Clients={args.clients}?SoakSeconds={args.seconds}"
+    command = base_command(args, True) + [url, f"-port={args.port}", "-unattended", "-nosound", "-log", "-abslog=" + os.path.join(args.logs, "Server.log")]
+    if args.editor:
+        command.append("-server")
+    return subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+
+def launch_client(args, index):
+    command = base_command(args, False) + [
+        f"127.0.0.1:{args.port}", "-game", "-nullrhi", "-nosound", "-unattended", "-windowed", "-log",
+        "-abslog=" + os.path.join(args.logs, f"Client{index}.log"),
+        f"-SoakSeed={args.seed + index}",
+        f"-PktLag={args.lag}", f"-PktLagVariance={args.lag_variance}", f"-PktLoss={args.loss}",
+    ]
+    if args.script:
+        command.append("-SoakScript=" + os.path.abspath(args.script))
+    return subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+
+def main():
+    args = parse_args()
+    if args.logs and os.path.isdir(args.logs):
+        shutil.rmtree(args.logs)
+    os.makedirs(args.logs, exist_ok=True)
+
+    report = args.report
+    if os.path.exists(report):
+        os.remove(report)
+
+    server = launch_server(args)
+    # give the server time to start listening before the clients knock
+    time.sleep(10)
+    clients = [launch_client(args, index) for index in range(args.clients)]
+    print(f"Soaking {args.clients} clients for {args.seconds:.0f}s, logs in {args.logs}")
+
+    try:
+        server.wait()
+    finally:
+        for client in clients:
+            client.terminate()
+        for client in clients:
+            try:
+                client.wait(timeout=30)
+            except subprocess.TimeoutExpired:
+                client.kill()
+        if server.poll() is None:
+            server.kill()
+
+    if not os.path.exists(report):
+        print(f"Server exited with {server.returncode} without writing {report}", file=sys.stderr)
+        return 1
+
+    with open(report) as report_file:
+        print(report_file.read())
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -8,6 +8,11 @@ public class IslandAdventureGame : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput" });
+		//the game mode and character headers sit at the module root rather than in Public
+		PublicIncludePaths.Add(ModuleDirectory);
+
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "AIModule", "NavigationSystem" });
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "Chaos", "PhysicsCore", "ReplicationGraph" });
 	}
 }
@@ -3,3 +3,6 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("IslandAdventure"), STATGROUP_IslandAdventure, STATCAT_Advanced);
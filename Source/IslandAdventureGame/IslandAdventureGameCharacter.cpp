@@ -4,6 +4,7 @@
 #include "Engine/LocalPlayer.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "GameFramework/Controller.h"
@@ -11,6 +12,10 @@
 #include "EnhancedInputSubsystems.h"
 #include "InputActionValue.h"
 #include "PlayerMovementComponent.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "StartupTimeline.h"
+#include "GrappleHistoryComponent.h"
 
 DEFINE_LOG_CATEGORY(LogTemplateCharacter);
 
@@ -52,6 +57,8 @@ AIslandAdventureGameCharacter::AIslandAdventureGameCharacter(const FObjectInitia
 	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
 	FollowCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
 
+	GrappleHistory = CreateDefaultSubobject<UGrappleHistoryComponent>(TEXT("GrappleHistory"));
+
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named ThirdPersonCharacter (to avoid direct content references in C++)
 }
@@ -62,6 +69,26 @@ void AIslandAdventureGameCharacter::BeginPlay()
 	Super::BeginPlay();
 }
 
+void AIslandAdventureGameCharacter::SetPooled(bool bPooled)
+{
+	if (bPooled)
+	{
+		MovementComponent->ResetClimbingState();
+		MovementComponent->StopMovementImmediately();
+		MovementComponent->DisableMovement();
+		ResetJumpState();
+	}
+	else
+	{
+		MovementComponent->SetDefaultMovementMode();
+	}
+
+	MovementComponent->SetComponentTickEnabled(!bPooled);
+	CameraBoom->SetComponentTickEnabled(!bPooled);
+	GetMesh()->SetComponentTickEnabled(!bPooled);
+	GrappleHistory->SetPooled(bPooled);
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Input
 
@@ -73,38 +100,65 @@ void AIslandAdventureGameCharacter::SetupPlayerInputComponent(UInputComponent* P
 	PlayerInputComponent->BindAction("ClimbDash", IE_Pressed, this, &AIslandAdventureGameCharacter::ClimbDash);
 	PlayerInputComponent->BindAction("Grapple", IE_Pressed, this, &AIslandAdventureGameCharacter::Grapple);
 
+	//the input assets are soft references so they don't get pulled into the startup load with the pawn class
+	TArray<FSoftObjectPath> InputAssets;
+	InputAssets.Add(DefaultMappingContext.ToSoftObjectPath());
+	InputAssets.Add(JumpAction.ToSoftObjectPath());
+	InputAssets.Add(MoveAction.ToSoftObjectPath());
+	InputAssets.Add(LookAction.ToSoftObjectPath());
+	InputAssetsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(InputAssets, FStreamableDelegate::CreateUObject(this, &AIslandAdventureGameCharacter::BindEnhancedInput), FStreamableManager::AsyncLoadHighPriority);
+}
+
+void AIslandAdventureGameCharacter::BindEnhancedInput()
+{
+	//input may have been torn down (unpossessed) while the assets were loading
+	if (!InputComponent)
+	{
+		return;
+	}
+
 	// Add Input Mapping Context
 	if (APlayerController* PlayerController = Cast<APlayerController>(GetController()))
 	{
 		if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
 		{
-			Subsystem->AddMappingContext(DefaultMappingContext, 0);
+			Subsystem->AddMappingContext(DefaultMappingContext.Get(), 0);
 		}
 	}
 	
 	// Set up action bindings
-	if (UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(PlayerInputComponent)) {
+	if (UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(InputComponent)) {
 		
 		// Jumping
-		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Started, this, &ACharacter::Jump);
-		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Completed, this, &ACharacter::StopJumping);
+		EnhancedInputComponent->BindAction(JumpAction.Get(), ETriggerEvent::Started, this, &ACharacter::Jump);
+		EnhancedInputComponent->BindAction(JumpAction.Get(), ETriggerEvent::Completed, this, &ACharacter::StopJumping);
 
 		// Moving
-		EnhancedInputComponent->BindAction(MoveAction, ETriggerEvent::Triggered, this, &AIslandAdventureGameCharacter::Move);
+		EnhancedInputComponent->BindAction(MoveAction.Get(), ETriggerEvent::Triggered, this, &AIslandAdventureGameCharacter::Move);
 
 		// Looking
-		EnhancedInputComponent->BindAction(LookAction, ETriggerEvent::Triggered, this, &AIslandAdventureGameCharacter::Look);
+		EnhancedInputComponent->BindAction(LookAction.Get(), ETriggerEvent::Triggered, this, &AIslandAdventureGameCharacter::Look);
 	}
 	else
 	{
 		UE_LOG(LogTemplateCharacter, Error, TEXT("'%s' Failed to find an Enhanced Input component! This template is built to use the Enhanced Input system. If you intend to use the legacy system, then you will need to update this C++ file."), *GetNameSafe(this));
 	}
+}
 
-	
+void AIslandAdventureGameCharacter::NotifyControllerChanged()
+{
+	Super::NotifyControllerChanged();
+
+	if (IsLocallyControlled() && IsPlayerControlled())
+	{
+		FStartupTimeline::Mark(EStartupMilestone::PawnPossessed);
+	}
 }
 
 void AIslandAdventureGameCharacter::Move(const FInputActionValue& Value)
 {
+	FStartupTimeline::Mark(EStartupMilestone::FirstInputAccepted);
+
 	// input is a Vector2D
 	FVector2D MovementVector = Value.Get<FVector2D>();
 
@@ -132,6 +186,8 @@ void AIslandAdventureGameCharacter::Move(const FInputActionValue& Value)
 
 void AIslandAdventureGameCharacter::Look(const FInputActionValue& Value)
 {
+	FStartupTimeline::Mark(EStartupMilestone::FirstInputAccepted);
+
 	// input is a Vector2D
 	FVector2D LookAxisVector = Value.Get<FVector2D>();
 
@@ -145,20 +201,24 @@ void AIslandAdventureGameCharacter::Look(const FInputActionValue& Value)
 
 void AIslandAdventureGameCharacter::Climb()
 {
+	FStartupTimeline::Mark(EStartupMilestone::FirstInputAccepted);
 	MovementComponent->TryClimbing();
 }
 
 void AIslandAdventureGameCharacter::CancelClimb()
 {
+	FStartupTimeline::Mark(EStartupMilestone::FirstInputAccepted);
 	MovementComponent->CancelClimbing();
 }
 
 void AIslandAdventureGameCharacter::ClimbDash()
 {
+	FStartupTimeline::Mark(EStartupMilestone::FirstInputAccepted);
 	MovementComponent->TryClimbDashing();
 }
 
 void AIslandAdventureGameCharacter::Grapple()
 {
+	FStartupTimeline::Mark(EStartupMilestone::FirstInputAccepted);
 	MovementComponent->TryGrapple();
 }
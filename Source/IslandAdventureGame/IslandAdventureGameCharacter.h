@@ -12,6 +12,7 @@ class UCameraComponent;
 class UInputMappingContext;
 class UInputAction;
 struct FInputActionValue;
+struct FStreamableHandle;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
 
@@ -20,6 +21,9 @@ class AIslandAdventureGameCharacter : public ACharacter
 {
 	GENERATED_BODY()
 
+	//plays the input actions below from a script during soak tests
+	friend class AClimbingSoakPlayerController;
+
 	/** Camera boom positioning the camera behind the character */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	USpringArmComponent* CameraBoom;
@@ -27,28 +31,37 @@ class AIslandAdventureGameCharacter : public ACharacter
 	/** Follow camera */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	UCameraComponent* FollowCamera;
+
+	/** Server-side transform history, lets grapples against this character and grapples it makes be checked at the client's time */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Character, meta = (AllowPrivateAccess = "true"))
+	class UGrappleHistoryComponent* GrappleHistory;
 	
-	/** MappingContext */
+	/** MappingContext, loaded asynchronously when input is set up */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
-	UInputMappingContext* DefaultMappingContext;
+	TSoftObjectPtr<UInputMappingContext> DefaultMappingContext;
 
 	/** Jump Input Action */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
-	UInputAction* JumpAction;
+	TSoftObjectPtr<UInputAction> JumpAction;
 
 	/** Move Input Action */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
-	UInputAction* MoveAction;
+	TSoftObjectPtr<UInputAction> MoveAction;
 
 	/** Look Input Action */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
-	UInputAction* LookAction;
+	TSoftObjectPtr<UInputAction> LookAction;
+
+	TSharedPtr<FStreamableHandle> InputAssetsHandle;
 
 public:
 	AIslandAdventureGameCharacter(const FObjectInitializer& ObjectInitializer);
 		
 	UFUNCTION(BlueprintPure)
 		FORCEINLINE UPlayerMovementComponent* GetPlayerMovementComponent() const { return MovementComponent; }
+
+	/** Parks the character in the game mode's pawn pool or takes it back out. Pooled characters don't tick, move or keep any climbing state */
+	void SetPooled(bool bPooled);
 protected:
 
 	/** Called for movement input */
@@ -69,6 +82,10 @@ protected:
 protected:
 	// APawn interface
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+	virtual void NotifyControllerChanged() override;
+
+	/** Binds the Enhanced Input actions once their assets have streamed in */
+	void BindEnhancedInput();
 	
 	// To add mapping context
 	virtual void BeginPlay();
@@ -2,14 +2,218 @@
 
 #include "IslandAdventureGameGameMode.h"
 #include "IslandAdventureGameCharacter.h"
-#include "UObject/ConstructorHelpers.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PawnMovementComponent.h"
+#include "StartupTimeline.h"
 
 AIslandAdventureGameGameMode::AIslandAdventureGameGameMode()
 {
-	// set default pawn class to our Blueprinted character
-	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnBPClass(TEXT("/Game/ThirdPerson/Blueprints/BP_ThirdPersonCharacter"));
-	if (PlayerPawnBPClass.Class != NULL)
+	// set default pawn class to our Blueprinted character, the native class is only used if the Blueprint fails to load
+	DefaultPawnSoftClass = TSoftClassPtr<APawn>(FSoftObjectPath(TEXT("/Game/ThirdPerson/Blueprints/BP_ThirdPersonCharacter.BP_ThirdPersonCharacter_C")));
+	DefaultPawnClass = AIslandAdventureGameCharacter::StaticClass();
+}
+
+void AIslandAdventureGameGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &AIslandAdventureGameGameMode::OnPostLoadMap);
+
+	if (DefaultPawnSoftClass.IsNull())
+	{
+		bDefaultPawnClassReady = true;
+		return;
+	}
+
+	//the pawn drags its mesh, anim blueprint and materials with it, so stream them in alongside the rest of the map
+	DefaultPawnClassHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		DefaultPawnSoftClass.ToSoftObjectPath(),
+		FStreamableDelegate::CreateUObject(this, &AIslandAdventureGameGameMode::OnDefaultPawnClassLoaded),
+		FStreamableManager::AsyncLoadHighPriority);
+}
+
+void AIslandAdventureGameGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	if (bDefaultPawnClassReady)
+	{
+		PrewarmPawnPool();
+	}
+}
+
+void AIslandAdventureGameGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	//players that join before the pawn class has streamed in are restarted once it is ready
+	if (!bDefaultPawnClassReady)
+	{
+		PlayersAwaitingPawnClass.AddUnique(NewPlayer);
+		return;
+	}
+
+	Super::HandleStartingNewPlayer_Implementation(NewPlayer);
+}
+
+void AIslandAdventureGameGameMode::OnDefaultPawnClassLoaded()
+{
+	if (UClass* LoadedPawnClass = DefaultPawnSoftClass.Get())
+	{
+		DefaultPawnClass = LoadedPawnClass;
+	}
+	else
+	{
+		UE_LOG(LogGameMode, Warning, TEXT("Failed to load default pawn class %s, falling back to %s"), *DefaultPawnSoftClass.ToString(), *GetNameSafe(DefaultPawnClass));
+	}
+	bDefaultPawnClassReady = true;
+
+	//the class can finish streaming before or after play starts, StartPlay covers the other case
+	if (HasMatchStarted())
+	{
+		PrewarmPawnPool();
+	}
+
+	for (const TWeakObjectPtr<APlayerController>& Player : PlayersAwaitingPawnClass)
+	{
+		if (Player.IsValid())
+		{
+			HandleStartingNewPlayer(Player.Get());
+		}
+	}
+	PlayersAwaitingPawnClass.Reset();
+}
+
+void AIslandAdventureGameGameMode::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	if (LoadedWorld != GetWorld())
+		return;
+
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+	FStartupTimeline::Mark(EStartupMilestone::MapLoaded);
+}
+
+APawn* AIslandAdventureGameGameMode::SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform)
+{
+	if (APawn* PooledPawn = TakePooledPawn(GetDefaultPawnClassForController(NewPlayer), SpawnTransform))
+	{
+		return PooledPawn;
+	}
+	return Super::SpawnDefaultPawnAtTransform_Implementation(NewPlayer, SpawnTransform);
+}
+
+APawn* AIslandAdventureGameGameMode::AcquirePawn(TSubclassOf<APawn> PawnClass, const FTransform& SpawnTransform)
+{
+	if (!PawnClass)
+		return nullptr;
+
+	if (APawn* PooledPawn = TakePooledPawn(PawnClass, SpawnTransform))
+	{
+		return PooledPawn;
+	}
+
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.Instigator = GetInstigator();
+	SpawnInfo.ObjectFlags |= RF_Transient;
+	return GetWorld()->SpawnActor<APawn>(PawnClass, SpawnTransform, SpawnInfo);
+}
+
+void AIslandAdventureGameGameMode::ReleasePawn(APawn* Pawn)
+{
+	if (!IsValid(Pawn) || PooledPawns.Contains(Pawn))
+		return;
+
+	if (AController* Controller = Pawn->GetController())
+	{
+		Controller->UnPossess();
+	}
+	SetPawnPooled(Pawn, true);
+	PooledPawns.Add(Pawn);
+}
+
+void AIslandAdventureGameGameMode::RespawnPlayer(AController* Player)
+{
+	if (!Player)
+		return;
+
+	if (APawn* OldPawn = Player->GetPawn())
+	{
+		ReleasePawn(OldPawn);
+	}
+	RestartPlayer(Player);
+}
+
+void AIslandAdventureGameGameMode::PrewarmPawnPool()
+{
+	UClass* PawnClass = DefaultPawnClass;
+	if (!PawnClass)
+		return;
+
+	//parked pawns don't collide, so nothing should stop them spawning on top of each other at the origin
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnInfo.ObjectFlags |= RF_Transient;
+	for (int32 Index = PooledPawns.Num(); Index < PawnPoolSize; Index++)
+	{
+		APawn* Pawn = GetWorld()->SpawnActor<APawn>(PawnClass, FTransform::Identity, SpawnInfo);
+		if (!Pawn)
+			break;
+
+		SetPawnPooled(Pawn, true);
+		PooledPawns.Add(Pawn);
+	}
+	UE_LOG(LogGameMode, Log, TEXT("Pawn pool prewarmed with %d %s"), PooledPawns.Num(), *GetNameSafe(PawnClass));
+}
+
+APawn* AIslandAdventureGameGameMode::TakePooledPawn(UClass* PawnClass, const FTransform& SpawnTransform)
+{
+	for (int32 Index = PooledPawns.Num() - 1; Index >= 0; Index--)
+	{
+		APawn* Pawn = PooledPawns[Index];
+		if (!IsValid(Pawn))
+		{
+			PooledPawns.RemoveAtSwap(Index);
+			continue;
+		}
+		if (Pawn->GetClass() != PawnClass)
+			continue;
+
+		PooledPawns.RemoveAtSwap(Index);
+		//move while collision is still off so the pawn doesn't sweep through the level on its way to the spawn point
+		Pawn->SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+		SetPawnPooled(Pawn, false);
+		return Pawn;
+	}
+	return nullptr;
+}
+
+void AIslandAdventureGameGameMode::SetPawnPooled(APawn* Pawn, bool bPooled)
+{
+	Pawn->SetActorHiddenInGame(bPooled);
+	Pawn->SetActorEnableCollision(!bPooled);
+	Pawn->SetActorTickEnabled(!bPooled);
+
+	if (AIslandAdventureGameCharacter* Character = Cast<AIslandAdventureGameCharacter>(Pawn))
+	{
+		Character->SetPooled(bPooled);
+	}
+	else if (UPawnMovementComponent* Movement = Pawn->GetMovementComponent())
+	{
+		Movement->StopMovementImmediately();
+		Movement->SetComponentTickEnabled(!bPooled);
+	}
+
+	//parked pawns leave replication entirely, the replication graph's grid gathers hidden actors like any other,
+	//so clients near the origin would keep receiving every parked pawn. Clients drop their copy when the channel closes
+	if (bPooled)
+	{
+		Pawn->SetReplicates(false);
+		GetWorld()->RemoveNetworkActor(Pawn);
+	}
+	else
 	{
-		DefaultPawnClass = PlayerPawnBPClass.Class;
+		//last, so the first update clients get already has the pawn visible at its spawn point
+		Pawn->SetReplicates(true);
+		Pawn->ForceNetUpdate();
 	}
 }
@@ -6,6 +6,8 @@
 #include "GameFramework/GameModeBase.h"
 #include "IslandAdventureGameGameMode.generated.h"
 
+struct FStreamableHandle;
+
 UCLASS(minimalapi)
 class AIslandAdventureGameGameMode : public AGameModeBase
 {
@@ -13,6 +15,50 @@ class AIslandAdventureGameGameMode : public AGameModeBase
 
 public:
 	AIslandAdventureGameGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual void StartPlay() override;
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+	virtual APawn* SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform) override;
+
+	/** Hands out a pooled pawn of PawnClass at SpawnTransform, only spawning a new one when none is parked */
+	UFUNCTION(BlueprintCallable, Category = "Pawn Pool")
+	APawn* AcquirePawn(TSubclassOf<APawn> PawnClass, const FTransform& SpawnTransform);
+
+	/** Unpossesses Pawn and parks it in the pool instead of destroying it */
+	UFUNCTION(BlueprintCallable, Category = "Pawn Pool")
+	void ReleasePawn(APawn* Pawn);
+
+	/** Parks the player's current pawn and restarts them at a player start with a pooled one */
+	UFUNCTION(BlueprintCallable, Category = "Pawn Pool")
+	void RespawnPlayer(AController* Player);
+
+	FORCEINLINE TSoftClassPtr<APawn> GetDefaultPawnSoftClass() const { return DefaultPawnSoftClass; }
+
+protected:
+	/** Pawn class for players. Loaded asynchronously while the map loads so it doesn't block startup */
+	UPROPERTY(Config, EditDefaultsOnly, Category = Classes)
+	TSoftClassPtr<APawn> DefaultPawnSoftClass;
+
+	/** Default pawns spawned and parked when play starts, so respawn waves and NPC churn reuse them instead of spawning */
+	UPROPERTY(Config, EditDefaultsOnly, Category = Classes, meta = (ClampMin = "0"))
+	int32 PawnPoolSize = 4;
+
+private:
+	void OnDefaultPawnClassLoaded();
+	void OnPostLoadMap(UWorld* LoadedWorld);
+	void PrewarmPawnPool();
+	APawn* TakePooledPawn(UClass* PawnClass, const FTransform& SpawnTransform);
+	void SetPawnPooled(APawn* Pawn, bool bPooled);
+
+	//parked pawns, hidden with collision and ticking off
+	UPROPERTY(Transient)
+	TArray<APawn*> PooledPawns;
+
+	TSharedPtr<FStreamableHandle> DefaultPawnClassHandle;
+	bool bDefaultPawnClassReady = false;
+	TArray<TWeakObjectPtr<APlayerController>> PlayersAwaitingPawnClass;
+	FDelegateHandle PostLoadMapHandle;
 };
 
 
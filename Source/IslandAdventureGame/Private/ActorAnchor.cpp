@@ -2,24 +2,45 @@
 
 
 #include "ActorAnchor.h"
+#include "AnchorBehaviorSubsystem.h"
 
 // Sets default values
 AActorAnchor::AActorAnchor()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	//anchors are moved by UAnchorBehaviorSubsystem in one batch instead of ticking on their own
+	PrimaryActorTick.bCanEverTick = false;
 
 }
 
 void AActorAnchor::InitAnchor(FVector Location, AActor* ActorToAttachTo)
 {
 	UpdateAnchorLocation(Location);
-	AttachToActor(ActorToAttachTo, FAttachmentTransformRules::KeepWorldTransform);
+	FollowBase(ActorToAttachTo ? ActorToAttachTo->GetRootComponent() : nullptr);
+}
+
+void AActorAnchor::FollowBase(USceneComponent* Base)
+{
+	if (UAnchorBehaviorSubsystem* Subsystem = UWorld::GetSubsystem<UAnchorBehaviorSubsystem>(GetWorld()))
+	{
+		Subsystem->SetAnchorBase(this, Base);
+	}
 }
 
 void AActorAnchor::UpdateAnchorLocation(FVector NewLocation)
 {
 	SetActorLocation(NewLocation);
+	if (UAnchorBehaviorSubsystem* Subsystem = UWorld::GetSubsystem<UAnchorBehaviorSubsystem>(GetWorld()))
+	{
+		Subsystem->SetAnchorLocation(this, NewLocation);
+	}
+}
+
+void AActorAnchor::Retract(FVector Target)
+{
+	if (UAnchorBehaviorSubsystem* Subsystem = UWorld::GetSubsystem<UAnchorBehaviorSubsystem>(GetWorld()))
+	{
+		Subsystem->RetractAnchor(this, Target);
+	}
 }
 
 // Called when the game starts or when spawned
@@ -27,12 +48,17 @@ void AActorAnchor::BeginPlay()
 {
 	Super::BeginPlay();
 	GEngine->AddOnScreenDebugMessage(-1, 1, FColor::Blue, TEXT("Beep"));
+	if (UAnchorBehaviorSubsystem* Subsystem = UWorld::GetSubsystem<UAnchorBehaviorSubsystem>(GetWorld()))
+	{
+		Subsystem->RegisterAnchor(this);
+	}
 }
 
-// Called every frame
-void AActorAnchor::Tick(float DeltaTime)
+void AActorAnchor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
-
+	if (UAnchorBehaviorSubsystem* Subsystem = UWorld::GetSubsystem<UAnchorBehaviorSubsystem>(GetWorld()))
+	{
+		Subsystem->UnregisterAnchor(this);
+	}
+	Super::EndPlay(EndPlayReason);
 }
-
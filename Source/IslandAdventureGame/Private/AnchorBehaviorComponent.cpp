@@ -6,29 +6,6 @@
 // Sets default values for this component's properties
 UAnchorBehaviorComponent::UAnchorBehaviorComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
-
-	// ...
-}
-
-
-// Called when the game starts
-void UAnchorBehaviorComponent::BeginPlay()
-{
-	Super::BeginPlay();
-
-	// ...
-	
+	//updated by UAnchorBehaviorSubsystem together with every other anchor
+	PrimaryComponentTick.bCanEverTick = false;
 }
-
-
-// Called every frame
-void UAnchorBehaviorComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
-{
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-
-	// ...
-}
-
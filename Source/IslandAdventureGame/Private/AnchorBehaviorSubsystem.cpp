@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AnchorBehaviorSubsystem.h"
+#include "ActorAnchor.h"
+#include "IslandAdventureGame.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+namespace AnchorBehaviorCVars
+{
+	static int32 ParallelThreshold = 256;
+	static FAutoConsoleVariableRef CVarParallelThreshold(
+		TEXT("IslandAdventure.Anchors.ParallelThreshold"),
+		ParallelThreshold,
+		TEXT("Number of anchors above which their behaviours are updated with a ParallelFor.\n")
+		TEXT("0: Always run on the game thread"),
+		ECVF_Default);
+}
+
+void UAnchorBehaviorSubsystem::Deinitialize()
+{
+	for (AActorAnchor* Anchor : Anchors)
+	{
+		Anchor->BehaviorIndex = INDEX_NONE;
+	}
+	States.Empty();
+	Bases.Empty();
+	BaseTransforms.Empty();
+	Anchors.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UAnchorBehaviorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAnchorBehaviorSubsystem, STATGROUP_IslandAdventure);
+}
+
+ETickableTickType UAnchorBehaviorSubsystem::GetTickableTickType() const
+{
+	//the class default object should never tick
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+void UAnchorBehaviorSubsystem::RegisterAnchor(AActorAnchor* Anchor)
+{
+	if (!Anchor || Anchor->BehaviorIndex != INDEX_NONE)
+		return;
+
+	FAnchorBehaviorState& State = States.AddDefaulted_GetRef();
+	State.Location = Anchor->GetActorLocation();
+	State.LocalOffset = FVector::ZeroVector;
+	State.RetractTarget = State.Location;
+	State.RetractSpeed = 0.f;
+	State.BreakAfterSeconds = 0.f;
+	State.Age = 0.f;
+	State.Behavior = EAnchorBehavior::FollowBase;
+	State.bHasBase = false;
+	State.bMoved = false;
+	State.bExpired = false;
+
+	if (const UAnchorBehaviorComponent* Settings = Anchor->FindComponentByClass<UAnchorBehaviorComponent>())
+	{
+		State.Behavior = Settings->Behavior;
+		State.RetractSpeed = Settings->RetractSpeed;
+		State.BreakAfterSeconds = Settings->BreakAfterSeconds;
+	}
+
+	Bases.AddDefaulted();
+	BaseTransforms.Add(FTransform::Identity);
+	Anchor->BehaviorIndex = Anchors.Add(Anchor);
+}
+
+void UAnchorBehaviorSubsystem::UnregisterAnchor(AActorAnchor* Anchor)
+{
+	if (!Anchor || !Anchors.IsValidIndex(Anchor->BehaviorIndex))
+		return;
+
+	const int32 Index = Anchor->BehaviorIndex;
+	States.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Bases.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	BaseTransforms.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Anchors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	if (Anchors.IsValidIndex(Index))
+	{
+		Anchors[Index]->BehaviorIndex = Index;
+	}
+	Anchor->BehaviorIndex = INDEX_NONE;
+}
+
+void UAnchorBehaviorSubsystem::SetAnchorBase(AActorAnchor* Anchor, USceneComponent* Base)
+{
+	if (!Anchor || !Anchors.IsValidIndex(Anchor->BehaviorIndex))
+		return;
+
+	const int32 Index = Anchor->BehaviorIndex;
+	FAnchorBehaviorState& State = States[Index];
+	Bases[Index] = Base;
+	State.bHasBase = Base != nullptr;
+	if (Base)
+	{
+		BaseTransforms[Index] = Base->GetComponentTransform();
+		State.LocalOffset = BaseTransforms[Index].InverseTransformPosition(State.Location);
+	}
+}
+
+void UAnchorBehaviorSubsystem::SetAnchorLocation(AActorAnchor* Anchor, const FVector& Location)
+{
+	if (!Anchor || !Anchors.IsValidIndex(Anchor->BehaviorIndex))
+		return;
+
+	const int32 Index = Anchor->BehaviorIndex;
+	FAnchorBehaviorState& State = States[Index];
+	State.Location = Location;
+	if (const USceneComponent* Base = Bases[Index].Get())
+	{
+		BaseTransforms[Index] = Base->GetComponentTransform();
+		State.LocalOffset = BaseTransforms[Index].InverseTransformPosition(Location);
+	}
+}
+
+void UAnchorBehaviorSubsystem::RetractAnchor(AActorAnchor* Anchor, const FVector& Target)
+{
+	if (!Anchor || !Anchors.IsValidIndex(Anchor->BehaviorIndex))
+		return;
+
+	FAnchorBehaviorState& State = States[Anchor->BehaviorIndex];
+	State.Behavior = EAnchorBehavior::Retract;
+	State.RetractTarget = Target;
+	if (State.RetractSpeed <= 0.f)
+	{
+		State.RetractSpeed = GetDefault<UAnchorBehaviorComponent>()->RetractSpeed;
+	}
+}
+
+void UAnchorBehaviorSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const int32 NumAnchors = States.Num();
+
+	//sample every base up front so the update below only touches the flat arrays
+	for (int32 Index = 0; Index < NumAnchors; Index++)
+	{
+		FAnchorBehaviorState& State = States[Index];
+		if (!State.bHasBase)
+			continue;
+
+		if (const USceneComponent* Base = Bases[Index].Get())
+		{
+			BaseTransforms[Index] = Base->GetComponentTransform();
+		}
+		else
+		{
+			//the base was destroyed, the anchor goes with it
+			State.bExpired = true;
+		}
+	}
+
+	const bool bParallel = AnchorBehaviorCVars::ParallelThreshold > 0 && NumAnchors > AnchorBehaviorCVars::ParallelThreshold;
+	ParallelFor(NumAnchors, [this, DeltaTime](int32 Index)
+	{
+		UpdateState(States[Index], BaseTransforms[Index], DeltaTime);
+	}, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+	//write back in one sweep, destroying as we go would reshuffle the slots under us
+	TArray<AActorAnchor*, TInlineAllocator<16>> ExpiredAnchors;
+	for (int32 Index = 0; Index < NumAnchors; Index++)
+	{
+		FAnchorBehaviorState& State = States[Index];
+		if (State.bExpired)
+		{
+			ExpiredAnchors.Add(Anchors[Index]);
+		}
+		else if (State.bMoved)
+		{
+			Anchors[Index]->SetActorLocation(State.Location);
+			State.bMoved = false;
+		}
+	}
+
+	for (AActorAnchor* Anchor : ExpiredAnchors)
+	{
+		Anchor->Destroy();
+	}
+}
+
+void UAnchorBehaviorSubsystem::UpdateState(FAnchorBehaviorState& State, const FTransform& BaseTransform, float DeltaTime) const
+{
+	if (State.bExpired)
+		return;
+
+	State.Age += DeltaTime;
+	if (State.BreakAfterSeconds > 0.f && State.Age >= State.BreakAfterSeconds)
+	{
+		State.bExpired = true;
+		return;
+	}
+
+	switch (State.Behavior)
+	{
+	case EAnchorBehavior::FollowBase:
+		if (State.bHasBase)
+		{
+			const FVector NewLocation = BaseTransform.TransformPosition(State.LocalOffset);
+			if (!NewLocation.Equals(State.Location, KINDA_SMALL_NUMBER))
+			{
+				State.Location = NewLocation;
+				State.bMoved = true;
+			}
+		}
+		break;
+	case EAnchorBehavior::Retract:
+	{
+		const FVector ToTarget = State.RetractTarget - State.Location;
+		const double Step = State.RetractSpeed * DeltaTime;
+		if (ToTarget.SizeSquared() <= Step * Step)
+		{
+			State.bExpired = true;
+		}
+		else
+		{
+			State.Location += ToTarget.GetUnsafeNormal() * Step;
+			State.bMoved = true;
+		}
+		break;
+	}
+	default:
+		break;
+	}
+}
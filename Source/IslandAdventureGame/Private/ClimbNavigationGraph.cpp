@@ -0,0 +1,479 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbNavigationGraph.h"
+#include "ClimbingProfile.h"
+#include "ClimbPathFollowingComponent.h"
+#include "Algo/Reverse.h"
+#include "Algo/StableSort.h"
+#include "Components/BoxComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "NavigationSystem.h"
+#include "NavLinkCustomComponent.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogClimbNavigation, Log, All);
+
+static FIntVector ToCell(const FVector& Location, float CellSize)
+{
+	return FIntVector(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize), FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+AClimbNavigationGraph::AClimbNavigationGraph()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Bounds = CreateDefaultSubobject<UBoxComponent>(TEXT("Bounds"));
+	Bounds->SetBoxExtent(FVector(2000.f));
+	Bounds->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	RootComponent = Bounds;
+}
+
+void AClimbNavigationGraph::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+	//the construction script doesn't run for actors loaded from a cooked level, registration always happens
+	CreateLinkComponents();
+}
+
+void AClimbNavigationGraph::BuildGraph()
+{
+	UWorld* World = GetWorld();
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	if (!World || !NavSys)
+	{
+		UE_LOG(LogClimbNavigation, Warning, TEXT("%s: no navigation system, build the navmesh before the climb graph"), *GetName());
+		return;
+	}
+
+	const UClimbingProfile& Profile = ClimbingProfile ? *ClimbingProfile : *GetDefault<UClimbingProfile>();
+	const float WalkableFloorZ = GetDefault<UCharacterMovementComponent>()->GetWalkableFloorZ();
+	const FBox Box = Bounds->Bounds.GetBox();
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ClimbNavigationBuild), false, this);
+	const FVector NavExtent(SampleSpacing, SampleSpacing, SampleSpacing * 2);
+
+	//sample the walls on a lattice, one node per half-spacing cell
+	TArray<FClimbNavNode> NewNodes;
+	TMap<FIntVector, int32> NodeByCell;
+	const FVector Directions[] = { FVector::ForwardVector, FVector::BackwardVector, FVector::RightVector, FVector::LeftVector };
+	for (double X = Box.Min.X; X <= Box.Max.X; X += SampleSpacing)
+	{
+		for (double Y = Box.Min.Y; Y <= Box.Max.Y; Y += SampleSpacing)
+		{
+			for (double Z = Box.Min.Z; Z <= Box.Max.Z; Z += SampleSpacing)
+			{
+				const FVector Start(X, Y, Z);
+				for (const FVector& Direction : Directions)
+				{
+					FHitResult Hit;
+					if (!World->LineTraceSingleByChannel(Hit, Start, Start + Direction * SampleSpacing, ECC_WorldStatic, QueryParams) || Hit.bStartPenetrating)
+						continue;
+
+					//same cosine-space test as UPlayerMovementComponent::IsClimbableSurface
+					if (Hit.ImpactNormal.Z >= Profile.CosMinClimbingAngle || Hit.ImpactNormal.Z <= Profile.CosMaxClimbingAngle)
+						continue;
+
+					const FVector Location = Hit.ImpactPoint + Hit.ImpactNormal * Profile.DistanceFromSurface;
+					const FIntVector Cell = ToCell(Location, SampleSpacing * 0.5f);
+					if (NodeByCell.Contains(Cell))
+						continue;
+
+					NodeByCell.Add(Cell, NewNodes.Num());
+					FClimbNavNode& Node = NewNodes.AddDefaulted_GetRef();
+					Node.Location = Location;
+					Node.Normal = Hit.ImpactNormal;
+				}
+			}
+		}
+	}
+
+	//connect nodes on the same face that can see each other
+	TMap<FIntVector, TArray<int32>> NodesBySpacingCell;
+	for (int32 Index = 0; Index < NewNodes.Num(); Index++)
+	{
+		NodesBySpacingCell.FindOrAdd(ToCell(NewNodes[Index].Location, SampleSpacing)).Add(Index);
+	}
+
+	TArray<TArray<FClimbNavEdge>> Adjacency;
+	Adjacency.SetNum(NewNodes.Num());
+	const float MaxStep = SampleSpacing * 1.5f;
+	for (int32 Index = 0; Index < NewNodes.Num(); Index++)
+	{
+		const FClimbNavNode& Node = NewNodes[Index];
+		const FIntVector Cell = ToCell(Node.Location, SampleSpacing);
+		for (int32 DX = -1; DX <= 1; DX++)
+		for (int32 DY = -1; DY <= 1; DY++)
+		for (int32 DZ = -1; DZ <= 1; DZ++)
+		{
+			const TArray<int32>* Candidates = NodesBySpacingCell.Find(Cell + FIntVector(DX, DY, DZ));
+			if (!Candidates)
+				continue;
+
+			for (int32 Other : *Candidates)
+			{
+				if (Other <= Index)
+					continue;
+
+				const FClimbNavNode& OtherNode = NewNodes[Other];
+				const float Distance = FVector::Dist(Node.Location, OtherNode.Location);
+				FHitResult Hit;
+				if (Distance > MaxStep || FVector::DotProduct(Node.Normal, OtherNode.Normal) < 0.5f
+					|| World->LineTraceSingleByChannel(Hit, Node.Location, OtherNode.Location, ECC_WorldStatic, QueryParams))
+					continue;
+
+				Adjacency[Index].Add({ Other, Distance });
+				Adjacency[Other].Add({ Index, Distance });
+			}
+		}
+	}
+
+	//wall feet and ledge tops that stand on the navmesh
+	TArray<TPair<int32, FVector>> Entries;
+	TArray<TPair<int32, FVector>> Exits;
+	for (int32 Index = 0; Index < NewNodes.Num(); Index++)
+	{
+		const FClimbNavNode& Node = NewNodes[Index];
+		FHitResult Hit;
+		FNavLocation NavLocation;
+
+		const FVector Foot = Node.Location + Node.Normal * SampleSpacing * 0.5f;
+		if (World->LineTraceSingleByChannel(Hit, Foot, Foot - FVector::UpVector * SampleSpacing * 1.5f, ECC_WorldStatic, QueryParams)
+			&& !Hit.bStartPenetrating && Hit.ImpactNormal.Z >= WalkableFloorZ && NavSys->ProjectPointToNavigation(Hit.ImpactPoint, NavLocation, NavExtent))
+		{
+			Entries.Add({ Index, NavLocation.Location });
+		}
+
+		const FVector Top = Node.Location + FVector::UpVector * SampleSpacing - Node.Normal * (Profile.DistanceFromSurface + SampleSpacing * 0.5f);
+		if (World->LineTraceSingleByChannel(Hit, Top, Top - FVector::UpVector * SampleSpacing * 2, ECC_WorldStatic, QueryParams)
+			&& !Hit.bStartPenetrating && Hit.ImpactNormal.Z >= WalkableFloorZ && NavSys->ProjectPointToNavigation(Hit.ImpactPoint, NavLocation, NavExtent))
+		{
+			Exits.Add({ Index, NavLocation.Location });
+		}
+	}
+
+	//connected pieces of wall, links only join entries and exits on the same piece
+	TArray<int32> Component;
+	Component.Init(INDEX_NONE, NewNodes.Num());
+	for (int32 Seed = 0; Seed < NewNodes.Num(); Seed++)
+	{
+		if (Component[Seed] != INDEX_NONE)
+			continue;
+
+		TArray<int32> Stack = { Seed };
+		Component[Seed] = Seed;
+		while (Stack.Num() > 0)
+		{
+			const int32 Current = Stack.Pop(EAllowShrinking::No);
+			for (const FClimbNavEdge& Edge : Adjacency[Current])
+			{
+				if (Component[Edge.To] == INDEX_NONE)
+				{
+					Component[Edge.To] = Seed;
+					Stack.Add(Edge.To);
+				}
+			}
+		}
+	}
+
+	//each exit gets its nearest entry and each entry its nearest exit, which keeps the link count linear in the wall count
+	TSet<FIntPoint> LinkPairs;
+	auto AddNearest = [&](const TArray<TPair<int32, FVector>>& From, const TArray<TPair<int32, FVector>>& To, bool bFromIsEntry)
+	{
+		for (const TPair<int32, FVector>& FromPoint : From)
+		{
+			int32 Best = INDEX_NONE;
+			double BestDistanceSquared = TNumericLimits<double>::Max();
+			for (int32 ToIndex = 0; ToIndex < To.Num(); ToIndex++)
+			{
+				const double DistanceSquared = FVector::DistSquared(FromPoint.Value, To[ToIndex].Value);
+				if (Component[To[ToIndex].Key] == Component[FromPoint.Key] && DistanceSquared < BestDistanceSquared)
+				{
+					Best = ToIndex;
+					BestDistanceSquared = DistanceSquared;
+				}
+			}
+
+			if (Best != INDEX_NONE)
+			{
+				LinkPairs.Add(bFromIsEntry ? FIntPoint(FromPoint.Key, To[Best].Key) : FIntPoint(To[Best].Key, FromPoint.Key));
+			}
+		}
+	};
+	AddNearest(Entries, Exits, true);
+	AddNearest(Exits, Entries, false);
+
+	//clusters on a coarse grid, nodes are reordered so every cluster owns a contiguous range
+	TMap<FIntVector, int32> ClusterByCell;
+	TArray<int32> NodeCluster;
+	NodeCluster.SetNum(NewNodes.Num());
+	for (int32 Index = 0; Index < NewNodes.Num(); Index++)
+	{
+		const FIntVector Cell = ToCell(NewNodes[Index].Location, ClusterSize);
+		const int32* Existing = ClusterByCell.Find(Cell);
+		NodeCluster[Index] = Existing ? *Existing : ClusterByCell.Add(Cell, ClusterByCell.Num());
+	}
+
+	TArray<int32> Order;
+	Order.SetNum(NewNodes.Num());
+	for (int32 Index = 0; Index < Order.Num(); Index++)
+	{
+		Order[Index] = Index;
+	}
+	Algo::StableSortBy(Order, [&NodeCluster](int32 Index) { return NodeCluster[Index]; });
+
+	TArray<int32> OldToNew;
+	OldToNew.SetNum(Order.Num());
+	for (int32 NewIndex = 0; NewIndex < Order.Num(); NewIndex++)
+	{
+		OldToNew[Order[NewIndex]] = NewIndex;
+	}
+
+	Modify();
+	Nodes.Reset(Order.Num());
+	Edges.Reset();
+	Clusters.Reset();
+	Clusters.SetNum(ClusterByCell.Num());
+	for (int32 NewIndex = 0; NewIndex < Order.Num(); NewIndex++)
+	{
+		const int32 OldIndex = Order[NewIndex];
+		FClimbNavNode& Node = Nodes.Add_GetRef(NewNodes[OldIndex]);
+		Node.Cluster = NodeCluster[OldIndex];
+		Node.FirstEdge = Edges.Num();
+		Node.NumEdges = Adjacency[OldIndex].Num();
+		for (const FClimbNavEdge& Edge : Adjacency[OldIndex])
+		{
+			Edges.Add({ OldToNew[Edge.To], Edge.Cost });
+		}
+
+		FClimbNavCluster& Cluster = Clusters[Node.Cluster];
+		if (Cluster.NumNodes == 0)
+		{
+			Cluster.FirstNode = NewIndex;
+		}
+		Cluster.NumNodes++;
+		Cluster.Center += Node.Location;
+	}
+
+	ClusterNeighbors.Reset();
+	for (int32 ClusterIndex = 0; ClusterIndex < Clusters.Num(); ClusterIndex++)
+	{
+		FClimbNavCluster& Cluster = Clusters[ClusterIndex];
+		Cluster.Center /= FMath::Max(1, Cluster.NumNodes);
+
+		TSet<int32> Neighbors;
+		for (int32 NodeIndex = Cluster.FirstNode; NodeIndex < Cluster.FirstNode + Cluster.NumNodes; NodeIndex++)
+		{
+			const FClimbNavNode& Node = Nodes[NodeIndex];
+			for (int32 EdgeIndex = Node.FirstEdge; EdgeIndex < Node.FirstEdge + Node.NumEdges; EdgeIndex++)
+			{
+				const int32 OtherCluster = Nodes[Edges[EdgeIndex].To].Cluster;
+				if (OtherCluster != ClusterIndex)
+				{
+					Neighbors.Add(OtherCluster);
+				}
+			}
+		}
+
+		Cluster.FirstNeighbor = ClusterNeighbors.Num();
+		Cluster.NumNeighbors = Neighbors.Num();
+		ClusterNeighbors.Append(Neighbors.Array());
+	}
+
+	TMap<int32, FVector> EntryLocations;
+	TMap<int32, FVector> ExitLocations;
+	for (const TPair<int32, FVector>& Entry : Entries)
+	{
+		EntryLocations.Add(Entry.Key, Entry.Value);
+	}
+	for (const TPair<int32, FVector>& Exit : Exits)
+	{
+		ExitLocations.Add(Exit.Key, Exit.Value);
+	}
+	Links.Reset();
+	for (const FIntPoint& Pair : LinkPairs)
+	{
+		//only real climbs, a foot and top at the same height are already joined by the navmesh
+		const FVector Start = EntryLocations[Pair.X];
+		const FVector End = ExitLocations[Pair.Y];
+		if (End.Z - Start.Z < SampleSpacing)
+			continue;
+
+		FClimbNavLink& Link = Links.AddDefaulted_GetRef();
+		Link.EntryNode = OldToNew[Pair.X];
+		Link.ExitNode = OldToNew[Pair.Y];
+		Link.Start = Start;
+		Link.End = End;
+	}
+
+	UE_LOG(LogClimbNavigation, Log, TEXT("%s: %d climb nodes, %d edges, %d clusters, %d nav links"), *GetName(), Nodes.Num(), Edges.Num(), Clusters.Num(), Links.Num());
+	CreateLinkComponents();
+}
+
+void AClimbNavigationGraph::CreateLinkComponents()
+{
+	for (UNavLinkCustomComponent* LinkComponent : LinkComponents)
+	{
+		if (LinkComponent)
+		{
+			LinkComponent->DestroyComponent();
+		}
+	}
+	LinkComponents.Reset(Links.Num());
+
+	const FTransform& ActorTransform = GetActorTransform();
+	for (const FClimbNavLink& Link : Links)
+	{
+		//links are relative to the actor, the graph itself is kept in world space
+		UNavLinkCustomComponent* LinkComponent = NewObject<UNavLinkCustomComponent>(this, NAME_None, RF_Transient);
+		LinkComponent->SetLinkData(ActorTransform.InverseTransformPosition(Link.Start), ActorTransform.InverseTransformPosition(Link.End), ENavLinkDirection::LeftToRight);
+		LinkComponent->SetMoveReachedLink(this, &AClimbNavigationGraph::OnClimbLinkReached);
+		LinkComponent->RegisterComponent();
+		LinkComponents.Add(LinkComponent);
+	}
+}
+
+void AClimbNavigationGraph::OnClimbLinkReached(UNavLinkCustomComponent* LinkComponent, UObject* PathingAgent, const FVector& DestPoint)
+{
+	const int32 LinkIndex = LinkComponents.IndexOfByKey(LinkComponent);
+	if (UClimbPathFollowingComponent* ClimbPathFollowing = Cast<UClimbPathFollowingComponent>(PathingAgent))
+	{
+		TArray<FVector> Waypoints;
+		if (Links.IsValidIndex(LinkIndex) && FindClimbPath(Links[LinkIndex].EntryNode, Links[LinkIndex].ExitNode, Waypoints))
+		{
+			ClimbPathFollowing->StartClimbPath(LinkComponent, MoveTemp(Waypoints), Nodes[Links[LinkIndex].EntryNode].Normal);
+			return;
+		}
+	}
+
+	//agents that can't climb hand the link straight back, their move then fails and they repath
+	if (UPathFollowingComponent* PathFollowing = Cast<UPathFollowingComponent>(PathingAgent))
+	{
+		PathFollowing->FinishUsingCustomLink(LinkComponent);
+	}
+}
+
+bool AClimbNavigationGraph::FindClusterCorridor(int32 StartCluster, int32 GoalCluster, TBitArray<>& OutCorridor) const
+{
+	OutCorridor.Init(false, Clusters.Num());
+
+	struct FOpen
+	{
+		int32 Cluster;
+		double Cost;
+		double Priority;
+		bool operator<(const FOpen& Other) const { return Priority < Other.Priority; }
+	};
+
+	TArray<double> Cost;
+	TArray<int32> Parent;
+	Cost.Init(TNumericLimits<double>::Max(), Clusters.Num());
+	Parent.Init(INDEX_NONE, Clusters.Num());
+
+	TArray<FOpen> Open;
+	Cost[StartCluster] = 0;
+	Open.HeapPush({ StartCluster, 0, FVector::Dist(Clusters[StartCluster].Center, Clusters[GoalCluster].Center) });
+	while (Open.Num() > 0)
+	{
+		FOpen Current;
+		Open.HeapPop(Current, EAllowShrinking::No);
+		//a cheaper way here was pushed after this entry and has already been expanded
+		if (Current.Cost > Cost[Current.Cluster])
+			continue;
+
+		if (Current.Cluster == GoalCluster)
+		{
+			//the corridor is the cluster path plus its neighbours, centres are only an estimate of where the nodes are
+			for (int32 Cluster = GoalCluster; Cluster != INDEX_NONE; Cluster = Parent[Cluster])
+			{
+				OutCorridor[Cluster] = true;
+				const FClimbNavCluster& PathCluster = Clusters[Cluster];
+				for (int32 Index = PathCluster.FirstNeighbor; Index < PathCluster.FirstNeighbor + PathCluster.NumNeighbors; Index++)
+				{
+					OutCorridor[ClusterNeighbors[Index]] = true;
+				}
+			}
+			return true;
+		}
+
+		const FClimbNavCluster& Cluster = Clusters[Current.Cluster];
+		for (int32 Index = Cluster.FirstNeighbor; Index < Cluster.FirstNeighbor + Cluster.NumNeighbors; Index++)
+		{
+			const int32 Neighbor = ClusterNeighbors[Index];
+			const double NewCost = Cost[Current.Cluster] + FVector::Dist(Cluster.Center, Clusters[Neighbor].Center);
+			if (NewCost < Cost[Neighbor])
+			{
+				Cost[Neighbor] = NewCost;
+				Parent[Neighbor] = Current.Cluster;
+				Open.HeapPush({ Neighbor, NewCost, NewCost + FVector::Dist(Clusters[Neighbor].Center, Clusters[GoalCluster].Center) });
+			}
+		}
+	}
+
+	return false;
+}
+
+bool AClimbNavigationGraph::FindClimbPath(int32 StartNode, int32 GoalNode, TArray<FVector>& OutWaypoints) const
+{
+	OutWaypoints.Reset();
+	if (!Nodes.IsValidIndex(StartNode) || !Nodes.IsValidIndex(GoalNode))
+		return false;
+
+	TBitArray<> Corridor;
+	if (!FindClusterCorridor(Nodes[StartNode].Cluster, Nodes[GoalNode].Cluster, Corridor))
+		return false;
+
+	struct FOpen
+	{
+		int32 Node;
+		double Cost;
+		double Priority;
+		bool operator<(const FOpen& Other) const { return Priority < Other.Priority; }
+	};
+
+	//only nodes inside the corridor are ever touched, so this stays sparse on a large graph
+	TMap<int32, TPair<double, int32>> Visited;
+	Visited.Reserve(MaxSearchNodes);
+	TArray<FOpen> Open;
+
+	const FVector GoalLocation = Nodes[GoalNode].Location;
+	Visited.Add(StartNode, { 0, INDEX_NONE });
+	Open.HeapPush({ StartNode, 0, FVector::Dist(Nodes[StartNode].Location, GoalLocation) });
+	int32 Expansions = 0;
+	while (Open.Num() > 0 && Expansions < MaxSearchNodes)
+	{
+		FOpen Current;
+		Open.HeapPop(Current, EAllowShrinking::No);
+		//stale entries left behind when a node was reached more cheaply are skipped, so each node is expanded once
+		const double CurrentCost = Visited[Current.Node].Key;
+		if (Current.Cost > CurrentCost)
+			continue;
+
+		Expansions++;
+		if (Current.Node == GoalNode)
+		{
+			for (int32 Node = GoalNode; Node != INDEX_NONE; Node = Visited[Node].Value)
+			{
+				OutWaypoints.Add(Nodes[Node].Location);
+			}
+			Algo::Reverse(OutWaypoints);
+			return true;
+		}
+
+		const FClimbNavNode& Node = Nodes[Current.Node];
+		for (int32 EdgeIndex = Node.FirstEdge; EdgeIndex < Node.FirstEdge + Node.NumEdges; EdgeIndex++)
+		{
+			const FClimbNavEdge& Edge = Edges[EdgeIndex];
+			if (!Corridor[Nodes[Edge.To].Cluster])
+				continue;
+
+			const double NewCost = CurrentCost + Edge.Cost;
+			TPair<double, int32>* Existing = Visited.Find(Edge.To);
+			if (!Existing || NewCost < Existing->Key)
+			{
+				Visited.Add(Edge.To, { NewCost, Current.Node });
+				Open.HeapPush({ Edge.To, NewCost, NewCost + FVector::Dist(Nodes[Edge.To].Location, GoalLocation) });
+			}
+		}
+	}
+
+	return false;
+}
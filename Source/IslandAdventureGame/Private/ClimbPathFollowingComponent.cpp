@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbPathFollowingComponent.h"
+#include "NavLinkCustomComponent.h"
+#include "PlayerMovementComponent.h"
+
+void UClimbPathFollowingComponent::StartClimbPath(UNavLinkCustomComponent* Link, TArray<FVector>&& Waypoints, const FVector& WallNormal)
+{
+	ActiveClimbLink = Link;
+	ClimbWaypoints = MoveTemp(Waypoints);
+	ClimbWallNormal = WallNormal;
+	CurrentClimbWaypoint = 0;
+	ClimbTime = 0;
+	bHasGrabbedWall = false;
+}
+
+void UClimbPathFollowingComponent::UpdatePathSegment()
+{
+	//the climb decides when the link is done, not the distance to the segment end
+	if (IsFollowingClimbPath())
+		return;
+
+	Super::UpdatePathSegment();
+}
+
+void UClimbPathFollowingComponent::FollowPathSegment(float DeltaTime)
+{
+	if (IsFollowingClimbPath())
+	{
+		FollowClimbPath(DeltaTime);
+		return;
+	}
+
+	Super::FollowPathSegment(DeltaTime);
+}
+
+void UClimbPathFollowingComponent::OnPathFinished(const FPathFollowingResult& Result)
+{
+	ActiveClimbLink = nullptr;
+	ClimbWaypoints.Reset();
+
+	Super::OnPathFinished(Result);
+}
+
+void UClimbPathFollowingComponent::FollowClimbPath(float DeltaTime)
+{
+	UPlayerMovementComponent* Climbing = Cast<UPlayerMovementComponent>(MovementComp);
+	ClimbTime += DeltaTime;
+	if (!Climbing || !Climbing->UpdatedComponent || ClimbTime > ClimbLinkTimeout)
+	{
+		FinishClimbPath();
+		return;
+	}
+
+	const FVector Location = Climbing->UpdatedComponent->GetComponentLocation();
+	if (!Climbing->IsClimbing())
+	{
+		//once we've been on the wall, dropping off it means we either mantled onto the ledge or fell
+		if (bHasGrabbedWall)
+		{
+			FinishClimbPath();
+			return;
+		}
+
+		//walk into the wall so the character turns to face it, then grab on
+		Climbing->RequestDirectMove(-ClimbWallNormal.GetSafeNormal2D() * Climbing->GetMaxSpeed(), false);
+		Climbing->TryClimbing();
+		return;
+	}
+	bHasGrabbedWall = true;
+
+	while (ClimbWaypoints.IsValidIndex(CurrentClimbWaypoint) && FVector::DistSquared(Location, ClimbWaypoints[CurrentClimbWaypoint]) < FMath::Square(ClimbWaypointAcceptanceRadius))
+	{
+		CurrentClimbWaypoint++;
+	}
+
+	//past the last node keep climbing up, the movement component mantles once it reaches the edge
+	const FVector SurfaceNormal = Climbing->GetClimbSurfaceNormal();
+	FVector Direction = ClimbWaypoints.IsValidIndex(CurrentClimbWaypoint) ? ClimbWaypoints[CurrentClimbWaypoint] - Location : FVector::UpVector;
+	Direction = FVector::VectorPlaneProject(Direction, SurfaceNormal).GetSafeNormal();
+	if (Direction.IsZero())
+	{
+		Direction = FVector::VectorPlaneProject(FVector::UpVector, SurfaceNormal).GetSafeNormal();
+	}
+
+	Climbing->RequestDirectMove(Direction * Climbing->GetMaxSpeed(), false);
+}
+
+void UClimbPathFollowingComponent::FinishClimbPath()
+{
+	UNavLinkCustomComponent* Link = ActiveClimbLink;
+	ActiveClimbLink = nullptr;
+	ClimbWaypoints.Reset();
+	FinishUsingCustomLink(Link);
+}
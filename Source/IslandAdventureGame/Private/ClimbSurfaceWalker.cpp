@@ -0,0 +1,395 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbSurfaceWalker.h"
+#include "IslandAdventureGame.h"
+#include "Chaos/TriangleMeshImplicitObject.h"
+#include "Components/PrimitiveComponent.h"
+#include "PhysicsEngine/BodySetup.h"
+
+DECLARE_CYCLE_STAT(TEXT("Climb Surface Walk"), STAT_ClimbSurfaceWalk, STATGROUP_IslandAdventure);
+DECLARE_CYCLE_STAT(TEXT("Climb Surface Attach"), STAT_ClimbSurfaceAttach, STATGROUP_IslandAdventure);
+
+namespace ClimbSurfaceMeshCache
+{
+	struct FEntry
+	{
+		TSharedPtr<const FClimbSurfaceMesh> Mesh;
+		int32 NumComponents = 0;
+	};
+
+	//game thread only, entries go away when the last component they were handed to is unregistered, or with their body setup
+	static TMap<TWeakObjectPtr<const UBodySetup>, FEntry> Meshes;
+	//the body setup each component was handed a mesh for
+	static TMap<TWeakObjectPtr<const UActorComponent>, TWeakObjectPtr<const UBodySetup>> Components;
+	static FDelegateHandle DestroyPhysicsStateHandle;
+
+	static void RemoveComponent(const UActorComponent* Component)
+	{
+		TWeakObjectPtr<const UBodySetup> BodySetup;
+		if (!Components.RemoveAndCopyValue(Component, BodySetup))
+			return;
+
+		FEntry* Entry = Meshes.Find(BodySetup);
+		if (Entry && --Entry->NumComponents <= 0)
+		{
+			Meshes.Remove(BodySetup);
+		}
+	}
+
+	//unregistering destroys the physics state, so does swapping the mesh, which also means the cached triangles are stale
+	static void OnDestroyPhysicsState(UActorComponent* Component)
+	{
+		if (IsInGameThread())
+		{
+			RemoveComponent(Component);
+		}
+	}
+}
+
+TSharedPtr<const FClimbSurfaceMesh> FClimbSurfaceMesh::Get(const UPrimitiveComponent& Component)
+{
+	using namespace ClimbSurfaceMeshCache;
+	check(IsInGameThread());
+
+	if (!DestroyPhysicsStateHandle.IsValid())
+	{
+		DestroyPhysicsStateHandle = UActorComponent::GlobalDestroyPhysicsDelegate.AddStatic(&OnDestroyPhysicsState);
+	}
+
+	const UBodySetup* BodySetup = Component.GetBodySetup();
+	if (!BodySetup || BodySetup->TriMeshGeometries.IsEmpty())
+		return nullptr;
+
+	const TWeakObjectPtr<const UBodySetup>* ComponentBodySetup = Components.Find(&Component);
+	if (ComponentBodySetup && ComponentBodySetup->Get() != BodySetup)
+	{
+		RemoveComponent(&Component);
+		ComponentBodySetup = nullptr;
+	}
+
+	FEntry* Entry = Meshes.Find(BodySetup);
+	if (!Entry)
+	{
+		for (auto It = Meshes.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
+		for (auto It = Components.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().IsValid() || !It.Value().IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
+
+		Entry = &Meshes.Add(BodySetup);
+		Entry->Mesh = Build(*BodySetup);
+	}
+
+	if (!ComponentBodySetup)
+	{
+		Components.Add(&Component, BodySetup);
+		Entry->NumComponents++;
+	}
+	return Entry->Mesh;
+}
+
+TSharedPtr<const FClimbSurfaceMesh> FClimbSurfaceMesh::Build(const UBodySetup& BodySetup)
+{
+	TSharedPtr<FClimbSurfaceMesh> Mesh = MakeShared<FClimbSurfaceMesh>();
+	for (const auto& TriMesh : BodySetup.TriMeshGeometries)
+	{
+		const int32 FirstVertex = Mesh->Vertices.Num();
+		const auto& Particles = TriMesh->Particles();
+		for (int32 Index = 0; Index < (int32)Particles.Size(); Index++)
+		{
+			Mesh->Vertices.Add(FVector3f(Particles.GetX(Index)));
+		}
+
+		auto AddTriangles = [&Mesh, FirstVertex](const auto& Indices)
+		{
+			for (const auto& Indexes : Indices)
+			{
+				Mesh->Triangles.Add(FIntVector(FirstVertex + Indexes[0], FirstVertex + Indexes[1], FirstVertex + Indexes[2]));
+			}
+		};
+		const Chaos::FTrimeshIndexBuffer& Elements = TriMesh->Elements();
+		if (Elements.RequiresLargeIndices())
+		{
+			AddTriangles(Elements.GetLargeIndexBuffer());
+		}
+		else
+		{
+			AddTriangles(Elements.GetSmallIndexBuffer());
+		}
+	}
+
+	//pair up triangles sharing an edge, edges used by more than two triangles keep the first pair
+	TMap<TPair<int32, int32>, int32> OpenEdges;
+	OpenEdges.Reserve(Mesh->Triangles.Num() * 3 / 2);
+	Mesh->Neighbours.Init(FIntVector(INDEX_NONE), Mesh->Triangles.Num());
+	Mesh->VertexNormals.SetNumZeroed(Mesh->Vertices.Num());
+	for (int32 TriangleIndex = 0; TriangleIndex < Mesh->Triangles.Num(); TriangleIndex++)
+	{
+		const FIntVector& Triangle = Mesh->Triangles[TriangleIndex];
+		for (int32 Edge = 0; Edge < 3; Edge++)
+		{
+			const int32 V0 = Triangle[Edge];
+			const int32 V1 = Triangle[(Edge + 1) % 3];
+			const TPair<int32, int32> Key(FMath::Min(V0, V1), FMath::Max(V0, V1));
+			if (const int32* Other = OpenEdges.Find(Key))
+			{
+				Mesh->Neighbours[TriangleIndex][Edge] = *Other / 3;
+				Mesh->Neighbours[*Other / 3][*Other % 3] = TriangleIndex;
+				OpenEdges.Remove(Key);
+			}
+			else
+			{
+				OpenEdges.Add(Key, TriangleIndex * 3 + Edge);
+			}
+		}
+
+		//unnormalised, so bigger triangles count for more
+		const FVector3f FaceNormal = (Mesh->Vertices[Triangle[1]] - Mesh->Vertices[Triangle[0]]) ^ (Mesh->Vertices[Triangle[2]] - Mesh->Vertices[Triangle[0]]);
+		for (int32 Corner = 0; Corner < 3; Corner++)
+		{
+			Mesh->VertexNormals[Triangle[Corner]] += FaceNormal;
+		}
+	}
+
+	for (FVector3f& Normal : Mesh->VertexNormals)
+	{
+		Normal.Normalize();
+	}
+
+	Mesh->BuildTriangleGrid();
+	return Mesh;
+}
+
+void FClimbSurfaceMesh::BuildTriangleGrid()
+{
+	TArray<FBox3f> TriangleBounds;
+	TriangleBounds.Reserve(Triangles.Num());
+	float TotalSize = 0;
+	for (const FIntVector& Triangle : Triangles)
+	{
+		FBox3f& Bounds = TriangleBounds.Emplace_GetRef(ForceInit);
+		Bounds += Vertices[Triangle[0]];
+		Bounds += Vertices[Triangle[1]];
+		Bounds += Vertices[Triangle[2]];
+		TotalSize += Bounds.GetSize().GetMax();
+	}
+	GridCellSize = FMath::Max(TotalSize / FMath::Max(1, Triangles.Num()), 1.f);
+
+	for (int32 TriangleIndex = 0; TriangleIndex < Triangles.Num(); TriangleIndex++)
+	{
+		const FIntVector Min = GetCell(TriangleBounds[TriangleIndex].Min);
+		const FIntVector Max = GetCell(TriangleBounds[TriangleIndex].Max);
+		const FIntVector Span = Max - Min + FIntVector(1);
+		if ((int64)Span.X * Span.Y * Span.Z > MaxGridCellsPerTriangle)
+		{
+			LargeTriangles.Add(TriangleIndex);
+			continue;
+		}
+
+		for (int32 X = Min.X; X <= Max.X; X++)
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+		for (int32 Z = Min.Z; Z <= Max.Z; Z++)
+		{
+			TriangleGrid.FindOrAdd(FIntVector(X, Y, Z)).Add(TriangleIndex);
+		}
+	}
+}
+
+FIntVector FClimbSurfaceMesh::GetCell(const FVector3f& Point) const
+{
+	return FIntVector(FMath::FloorToInt32(Point.X / GridCellSize), FMath::FloorToInt32(Point.Y / GridCellSize), FMath::FloorToInt32(Point.Z / GridCellSize));
+}
+
+void FClimbSurfaceMesh::GatherTriangles(const FVector3f& Point, float Radius, TArray<int32>& OutTriangles) const
+{
+	OutTriangles = LargeTriangles;
+
+	const FIntVector Min = GetCell(Point - FVector3f(Radius));
+	const FIntVector Max = GetCell(Point + FVector3f(Radius));
+	const FIntVector Span = Max - Min + FIntVector(1);
+	if ((int64)Span.X * Span.Y * Span.Z > MaxGridCellsPerQuery)
+	{
+		OutTriangles.SetNumUninitialized(Triangles.Num());
+		for (int32 TriangleIndex = 0; TriangleIndex < Triangles.Num(); TriangleIndex++)
+		{
+			OutTriangles[TriangleIndex] = TriangleIndex;
+		}
+		return;
+	}
+
+	for (int32 X = Min.X; X <= Max.X; X++)
+	for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+	for (int32 Z = Min.Z; Z <= Max.Z; Z++)
+	{
+		if (const TArray<int32>* CellTriangles = TriangleGrid.Find(FIntVector(X, Y, Z)))
+		{
+			OutTriangles.Append(*CellTriangles);
+		}
+	}
+}
+
+bool FClimbSurfaceWalker::Attach(const UPrimitiveComponent* InComponent, const FVector& WorldPoint, const FVector& Viewpoint, float MaxDistance)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbSurfaceAttach);
+
+	Detach();
+	if (!InComponent)
+		return false;
+
+	TSharedPtr<const FClimbSurfaceMesh> NewMesh = FClimbSurfaceMesh::Get(*InComponent);
+	if (!NewMesh)
+		return false;
+
+	//only paid when grabbing a new mesh, after that the walk keeps track of the triangle
+	const FTransform& Transform = InComponent->GetComponentTransform();
+	const FVector Local = Transform.InverseTransformPosition(WorldPoint);
+	const float MaxLocalDistance = MaxDistance / FMath::Max(Transform.GetMinimumAxisScale(), UE_KINDA_SMALL_NUMBER);
+	float BestDistanceSquared = FMath::Square(MaxLocalDistance);
+	int32 BestTriangle = INDEX_NONE;
+	FVector BestPoint;
+	TArray<int32> Candidates;
+	NewMesh->GatherTriangles(FVector3f(Local), MaxLocalDistance, Candidates);
+	for (const int32 TriangleIndex : Candidates)
+	{
+		const FIntVector& Indices = NewMesh->Triangles[TriangleIndex];
+		const FVector Closest = FMath::ClosestPointOnTriangleToPoint(Local, FVector(NewMesh->Vertices[Indices[0]]), FVector(NewMesh->Vertices[Indices[1]]), FVector(NewMesh->Vertices[Indices[2]]));
+		const float DistanceSquared = FVector::DistSquared(Closest, Local);
+		if (DistanceSquared < BestDistanceSquared)
+		{
+			BestDistanceSquared = DistanceSquared;
+			BestTriangle = TriangleIndex;
+			BestPoint = Closest;
+		}
+	}
+	if (BestTriangle == INDEX_NONE)
+		return false;
+
+	Mesh = MoveTemp(NewMesh);
+	Component = InComponent;
+	Triangle = BestTriangle;
+	LocalPoint = BestPoint;
+
+	bFlipNormals = false;
+	bFlipNormals = (GetWorldNormal() | (Viewpoint - GetWorldPoint())) < 0;
+	return true;
+}
+
+void FClimbSurfaceWalker::Detach()
+{
+	Mesh.Reset();
+	Component.Reset();
+	Triangle = INDEX_NONE;
+}
+
+void FClimbSurfaceWalker::GetWorldTriangle(const FTransform& Transform, int32 TriangleIndex, FVector& OutA, FVector& OutB, FVector& OutC) const
+{
+	const FIntVector& Indices = Mesh->Triangles[TriangleIndex];
+	OutA = Transform.TransformPosition(FVector(Mesh->Vertices[Indices[0]]));
+	OutB = Transform.TransformPosition(FVector(Mesh->Vertices[Indices[1]]));
+	OutC = Transform.TransformPosition(FVector(Mesh->Vertices[Indices[2]]));
+}
+
+bool FClimbSurfaceWalker::Walk(const FVector& WorldDelta, float MinCreaseCos)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbSurfaceWalk);
+
+	if (!IsAttached())
+		return false;
+
+	//walked in world space so scaled and mirrored meshes need no special cases
+	const FTransform& Transform = Component->GetComponentTransform();
+	FVector Point = Transform.TransformPosition(LocalPoint);
+	FVector Remaining = WorldDelta;
+	FVector A, B, C;
+	GetWorldTriangle(Transform, Triangle, A, B, C);
+	FVector Normal = ((B - A) ^ (C - A)).GetSafeNormal();
+	Remaining = FVector::VectorPlaneProject(Remaining, Normal);
+
+	int32 Step = 0;
+	for (; Step < MaxWalkSteps && !Remaining.IsNearlyZero(); Step++)
+	{
+		Point = FVector::PointPlaneProject(Point, A, Normal);
+
+		//find the edge the move leaves through, edge normals cross the face normal so they point into the triangle
+		const FVector Corners[3] = { A, B, C };
+		float ExitTime = 1.f;
+		int32 ExitEdge = INDEX_NONE;
+		for (int32 Edge = 0; Edge < 3; Edge++)
+		{
+			const FVector EdgeNormal = Normal ^ (Corners[(Edge + 1) % 3] - Corners[Edge]);
+			const float Approach = EdgeNormal | Remaining;
+			if (Approach >= 0)
+				continue;
+
+			const float Time = FMath::Max((EdgeNormal | (Point - Corners[Edge])) / -Approach, 0.f);
+			if (Time < ExitTime)
+			{
+				ExitTime = Time;
+				ExitEdge = Edge;
+			}
+		}
+
+		Point += Remaining * ExitTime;
+		if (ExitEdge == INDEX_NONE)
+		{
+			Remaining = FVector::ZeroVector;
+			break;
+		}
+
+		const int32 NextTriangle = Mesh->Neighbours[Triangle][ExitEdge];
+		if (NextTriangle == INDEX_NONE)
+			return false;
+
+		FVector NextA, NextB, NextC;
+		GetWorldTriangle(Transform, NextTriangle, NextA, NextB, NextC);
+		const FVector NextNormal = ((NextB - NextA) ^ (NextC - NextA)).GetSafeNormal();
+		if ((Normal | NextNormal) < MinCreaseCos)
+			return false;
+
+		//fold the rest of the move over the edge onto the next triangle, keeping its length
+		const float RemainingLength = Remaining.Size() * (1.f - ExitTime);
+		Remaining = FVector::VectorPlaneProject(Remaining, NextNormal).GetSafeNormal() * RemainingLength;
+		Triangle = NextTriangle;
+		A = NextA;
+		B = NextB;
+		C = NextC;
+		Normal = NextNormal;
+	}
+
+	LocalPoint = Transform.InverseTransformPosition(Point);
+	//a move that needs more triangles than this is better served by a fresh probe
+	return Remaining.IsNearlyZero();
+}
+
+FVector FClimbSurfaceWalker::GetWorldPoint() const
+{
+	return IsAttached() ? Component->GetComponentTransform().TransformPosition(LocalPoint) : FVector::ZeroVector;
+}
+
+FVector FClimbSurfaceWalker::GetWorldNormal() const
+{
+	if (!IsAttached())
+		return FVector::ZeroVector;
+
+	const FIntVector& Indices = Mesh->Triangles[Triangle];
+	const FVector3f& A = Mesh->Vertices[Indices[0]];
+	const FVector3f& B = Mesh->Vertices[Indices[1]];
+	const FVector3f& C = Mesh->Vertices[Indices[2]];
+	const FVector Weights = FMath::ComputeBaryCentric2D(LocalPoint, FVector(A), FVector(B), FVector(C));
+	const FVector3f LocalNormal = Mesh->VertexNormals[Indices[0]] * Weights.X + Mesh->VertexNormals[Indices[1]] * Weights.Y + Mesh->VertexNormals[Indices[2]] * Weights.Z;
+
+	//normals transform with the inverse scale
+	const FTransform& Transform = Component->GetComponentTransform();
+	const FVector WorldNormal = Transform.GetRotation().RotateVector(FVector(LocalNormal) * Transform.GetSafeScaleReciprocal(Transform.GetScale3D())).GetSafeNormal();
+	return bFlipNormals ? -WorldNormal : WorldNormal;
+}
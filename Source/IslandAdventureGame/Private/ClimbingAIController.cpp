@@ -0,0 +1,10 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbingAIController.h"
+#include "ClimbPathFollowingComponent.h"
+
+AClimbingAIController::AClimbingAIController(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UClimbPathFollowingComponent>(TEXT("PathFollowingComponent")))
+{
+}
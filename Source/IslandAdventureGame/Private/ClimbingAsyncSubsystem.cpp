@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbingAsyncSubsystem.h"
+#include "ClimbingProfile.h"
+#include "ClimbingSolverMath.h"
+#include "Chaos/SimCallbackInput.h"
+#include "Chaos/SimCallbackObject.h"
+#include "Engine/World.h"
+#include "PBDRigidsSolver.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PhysicsEngine/PhysicsSettings.h"
+
+struct FClimbingAsyncInput : public Chaos::FSimCallbackInput
+{
+	TArray<FClimbingAsyncIntent> Intents;
+	//climbers that stopped, the physics thread stops stepping these
+	TArray<int32> RemovedSlots;
+
+	void Reset()
+	{
+		Intents.Reset();
+		RemovedSlots.Reset();
+	}
+};
+
+struct FClimbingAsyncOutput : public Chaos::FSimCallbackOutput
+{
+	//indexed by slot, only slots stepped this time are valid
+	TArray<FClimbingAsyncResult> Results;
+
+	void Reset()
+	{
+		Results.Reset();
+	}
+};
+
+/** Lives on the physics thread, everything in here only sees plain data copied out of the intents */
+class FClimbingAsyncCallback : public Chaos::TSimCallbackObject<FClimbingAsyncInput, FClimbingAsyncOutput>
+{
+private:
+	struct FClimberState
+	{
+		//the latest intent the game thread sent, reused for every step until a newer one arrives
+		FClimbingAsyncIntent Intent;
+		bool bActive = false;
+		FVector Location = FVector::ZeroVector;
+		FQuat Rotation = FQuat::Identity;
+		FVector Velocity = FVector::ZeroVector;
+		uint32 ResyncSequence = MAX_uint32;
+		uint32 DashSequence = 0;
+		FVector DashDirection = FVector::ZeroVector;
+		float DashTime = 0;
+		bool bDashing = false;
+	};
+
+	virtual void OnPreSimulate_Internal() override
+	{
+		//the same input comes back for every step it covers, and none at all once the game thread stops sending,
+		//so applying it is idempotent and every active climber is stepped either way
+		if (const FClimbingAsyncInput* Input = GetConsumerInput_Internal())
+		{
+			for (const int32 Slot : Input->RemovedSlots)
+			{
+				if (States.IsValidIndex(Slot))
+				{
+					States[Slot].bActive = false;
+				}
+			}
+			for (const FClimbingAsyncIntent& Intent : Input->Intents)
+			{
+				if (Intent.Slot >= States.Num())
+				{
+					States.SetNum(Intent.Slot + 1);
+				}
+				States[Intent.Slot].Intent = Intent;
+				States[Intent.Slot].bActive = true;
+			}
+		}
+
+		const float DeltaTime = GetDeltaTime_Internal();
+		FClimbingAsyncOutput& Output = GetProducerOutputData_Internal();
+		Output.Results.SetNum(States.Num());
+		for (int32 Slot = 0; Slot < States.Num(); Slot++)
+		{
+			FClimberState& State = States[Slot];
+			if (!State.bActive)
+				continue;
+
+			Step(State, DeltaTime);
+
+			FClimbingAsyncResult& Result = Output.Results[Slot];
+			Result.Location = State.Location;
+			Result.Rotation = State.Rotation;
+			Result.Velocity = State.Velocity;
+			Result.ResyncSequence = State.ResyncSequence;
+			Result.bValid = true;
+		}
+	}
+
+	//the same integration PhysClimbing does on the game thread, minus the scene queries
+	static void Step(FClimberState& State, float DeltaTime)
+	{
+		const FClimbingAsyncIntent& Intent = State.Intent;
+		if (State.ResyncSequence != Intent.ResyncSequence)
+		{
+			State.ResyncSequence = Intent.ResyncSequence;
+			State.Location = Intent.Location;
+			State.Rotation = Intent.Rotation;
+			State.Velocity = Intent.Velocity;
+			State.bDashing = false;
+			State.DashSequence = Intent.DashSequence;
+		}
+
+		if (State.DashSequence != Intent.DashSequence)
+		{
+			State.DashSequence = Intent.DashSequence;
+			State.DashDirection = Intent.DashDirection;
+			State.DashTime = 0;
+			State.bDashing = Intent.DashSpeedSamples.IsValid();
+		}
+
+		if (State.bDashing)
+		{
+			State.DashTime += DeltaTime;
+			State.bDashing = State.DashTime < Intent.DashDuration;
+		}
+
+		if (State.bDashing)
+		{
+			const TArray<float>& Samples = *Intent.DashSpeedSamples;
+			const float SampleTime = FMath::Clamp(State.DashTime * UClimbingProfile::ClimbDashSampleRate, 0.f, (float)(Samples.Num() - 1));
+			const int32 SampleIndex = FMath::FloorToInt32(SampleTime);
+			const float Speed = FMath::Lerp(Samples[SampleIndex], Samples[FMath::Min(SampleIndex + 1, Samples.Num() - 1)], SampleTime - SampleIndex);
+
+			const FVector DashDirection = FVector::VectorPlaneProject(State.DashDirection, Intent.SurfaceNormal.GetSafeNormal2D());
+			State.Velocity = DashDirection * Speed;
+		}
+		else if (Intent.Acceleration.IsNearlyZero() || State.Velocity.SizeSquared() > FMath::Square(Intent.MaxSpeed))
+		{
+			//frictionless braking, as CalcVelocity does with no input
+			const float Speed = State.Velocity.Size();
+			const float NewSpeed = FMath::Max(0.f, Speed - Intent.Deceleration * DeltaTime);
+			State.Velocity = Speed > UE_KINDA_SMALL_NUMBER ? State.Velocity * (NewSpeed / Speed) : FVector::ZeroVector;
+		}
+		else
+		{
+			State.Velocity += Intent.Acceleration.GetClampedToMaxSize(Intent.MaxAcceleration) * DeltaTime;
+			State.Velocity = State.Velocity.GetClampedToMaxSize(Intent.MaxSpeed);
+		}
+
+		State.Location += State.Velocity * DeltaTime;
+
+		if (!Intent.SurfaceNormal.IsZero())
+		{
+			//in floats around the climbing position, as SnapToClimbingSurface and GetClimbingRotation do
+			const float SpeedScale = ClimbingSolverMath::SpeedScale((float)State.Velocity.Size(), Intent.InvMaxSpeed);
+			const FClimbingLocalFrame Frame(Intent.SurfacePosition);
+			const FVector3f SurfaceNormal = FVector3f(Intent.SurfaceNormal);
+			const FVector3f Offset = ClimbingSolverMath::SnapOffset(-Frame.ToLocal(State.Location), FVector3f(State.Rotation.GetForwardVector()), SurfaceNormal, Intent.DistanceFromSurface);
+			State.Location += FVector(Offset * ClimbingSolverMath::ConvergenceAlpha(Intent.SnapSpeed * SpeedScale, DeltaTime));
+
+			const float RotationAlpha = ClimbingSolverMath::ConvergenceAlpha(Intent.RotationSpeed * SpeedScale, DeltaTime);
+			State.Rotation = FQuat(ClimbingSolverMath::ClimbingRotation(FQuat4f(State.Rotation), SurfaceNormal, RotationAlpha));
+		}
+	}
+
+	//indexed by slot, only ever touched on the physics thread
+	TArray<FClimberState> States;
+};
+
+bool UClimbingAsyncSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return Super::ShouldCreateSubsystem(Outer) && UPhysicsSettings::Get()->bTickPhysicsAsync;
+}
+
+void UClimbingAsyncSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FPhysScene* PhysScene = InWorld.GetPhysicsScene();
+	Chaos::FPhysicsSolver* Solver = PhysScene ? PhysScene->GetSolver() : nullptr;
+	if (Solver)
+	{
+		Callback = Solver->CreateAndRegisterSimCallbackObject_External<FClimbingAsyncCallback>();
+	}
+}
+
+void UClimbingAsyncSubsystem::Deinitialize()
+{
+	if (Callback)
+	{
+		FPhysScene* PhysScene = GetWorld()->GetPhysicsScene();
+		if (Chaos::FPhysicsSolver* Solver = PhysScene ? PhysScene->GetSolver() : nullptr)
+		{
+			Solver->UnregisterAndFreeSimCallbackObject_External(Callback);
+		}
+		Callback = nullptr;
+	}
+
+	Super::Deinitialize();
+}
+
+int32 UClimbingAsyncSubsystem::RegisterClimber()
+{
+	const int32 Slot = FreeSlots.Num() > 0 ? FreeSlots.Pop(EAllowShrinking::No) : NumSlots++;
+	if (Slot >= SlotResults.Num())
+	{
+		SlotResults.SetNum(Slot + 1);
+	}
+	//the new climber asks for its first sequence straight after registering
+	SlotResults[Slot] = FSlotResults();
+	SlotResults[Slot].FirstResyncSequence = ResyncCounter + 1;
+	return Slot;
+}
+
+void UClimbingAsyncSubsystem::UnregisterClimber(int32 Slot)
+{
+	if (Slot == INDEX_NONE)
+		return;
+
+	FreeSlots.Add(Slot);
+	if (Callback)
+	{
+		Callback->GetProducerInputData_External()->RemovedSlots.Add(Slot);
+	}
+	if (SlotResults.IsValidIndex(Slot))
+	{
+		SlotResults[Slot] = FSlotResults();
+	}
+}
+
+void UClimbingAsyncSubsystem::QueueIntent(const FClimbingAsyncIntent& Intent)
+{
+	if (!Callback || Intent.Slot == INDEX_NONE)
+		return;
+
+	//every call in the same game frame lands in the same input
+	Callback->GetProducerInputData_External()->Intents.Add(Intent);
+}
+
+void UClimbingAsyncSubsystem::PullResults()
+{
+	if (PulledFrame == GFrameCounter)
+		return;
+
+	PulledFrame = GFrameCounter;
+	while (Chaos::TSimCallbackOutputHandle<FClimbingAsyncOutput> Output = Callback->PopFutureOutputData_External())
+	{
+		if (SlotResults.Num() < Output->Results.Num())
+		{
+			SlotResults.SetNum(Output->Results.Num());
+		}
+		for (int32 Slot = 0; Slot < Output->Results.Num(); Slot++)
+		{
+			const FClimbingAsyncResult& Result = Output->Results[Slot];
+			FSlotResults& Results = SlotResults[Slot];
+			if (!Result.bValid || Result.ResyncSequence < Results.FirstResyncSequence)
+				continue;
+
+			Results.Previous = Results.Latest;
+			Results.PreviousTime = Results.LatestTime;
+			Results.Latest = Result;
+			Results.LatestTime = Output->InternalTime;
+		}
+	}
+}
+
+bool UClimbingAsyncSubsystem::GetInterpolatedResult(int32 Slot, FClimbingAsyncResult& OutResult)
+{
+	if (!Callback)
+		return false;
+
+	PullResults();
+
+	if (!SlotResults.IsValidIndex(Slot) || !SlotResults[Slot].Latest.bValid)
+		return false;
+
+	const FSlotResults& Results = SlotResults[Slot];
+	const FClimbingAsyncResult& Latest = Results.Latest;
+	if (!Results.Previous.bValid || Results.LatestTime <= Results.PreviousTime)
+	{
+		OutResult = Latest;
+		return true;
+	}
+
+	//render between the two physics steps either side of where the game thread is
+	const FClimbingAsyncResult& Previous = Results.Previous;
+	const double ResultsTime = GetWorld()->GetPhysicsScene()->GetSolver()->GetPhysicsResultsTime_External();
+	const float Alpha = FMath::Clamp((ResultsTime - Results.PreviousTime) / (Results.LatestTime - Results.PreviousTime), 0.0, 1.0);
+	OutResult.Location = FMath::Lerp(Previous.Location, Latest.Location, Alpha);
+	OutResult.Rotation = FQuat::Slerp(Previous.Rotation, Latest.Rotation, Alpha);
+	OutResult.Velocity = FMath::Lerp(Previous.Velocity, Latest.Velocity, Alpha);
+	OutResult.bValid = true;
+	return true;
+}
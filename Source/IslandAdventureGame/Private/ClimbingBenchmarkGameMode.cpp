@@ -0,0 +1,281 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbingBenchmarkGameMode.h"
+#include "ClimbingBotController.h"
+#include "IslandAdventureGameCharacter.h"
+#include "PlayerMovementComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "HAL/PlatformMemory.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogClimbingBenchmark, Log, All);
+
+namespace ClimbingBenchmark
+{
+	//the engine cube is 100cm on each side, blocks are built by scaling it
+	static const TCHAR* CubeMeshPath = TEXT("/Engine/BasicShapes/Cube.Cube");
+	static constexpr float CubeSize = 100.f;
+
+	static double Percentile(const TArray<double>& SortedValues, double Fraction)
+	{
+		if (SortedValues.IsEmpty())
+			return 0;
+
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * SortedValues.Num()) - 1, 0, SortedValues.Num() - 1);
+		return SortedValues[Index];
+	}
+}
+
+AClimbingBenchmarkGameMode::AClimbingBenchmarkGameMode()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	Populations = { 1, 10, 100, 500 };
+}
+
+void AClimbingBenchmarkGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	Seed = UGameplayStatics::GetIntOption(Options, TEXT("Seed"), 0);
+	Random.Initialize(Seed);
+
+	const FString PopulationOption = UGameplayStatics::ParseOption(Options, TEXT("Populations"));
+	if (!PopulationOption.IsEmpty())
+	{
+		TArray<FString> PopulationNames;
+		PopulationOption.ParseIntoArray(PopulationNames, TEXT("+"), true);
+		Populations.Reset();
+		for (const FString& PopulationName : PopulationNames)
+		{
+			Populations.Add(FCString::Atoi(*PopulationName));
+		}
+	}
+
+	//a benchmark can afford to block here, and it wants the same pawn players get
+	BotClass = GetDefaultPawnSoftClass().LoadSynchronous();
+	if (!BotClass)
+	{
+		BotClass = AIslandAdventureGameCharacter::StaticClass();
+	}
+}
+
+void AClimbingBenchmarkGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	//the local player only watches, it doesn't get a pawn
+}
+
+void AClimbingBenchmarkGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &AClimbingBenchmarkGameMode::OnWorldTickStart);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &AClimbingBenchmarkGameMode::OnWorldPostActorTick);
+
+	GenerateCliffs();
+
+	if (Populations.IsEmpty())
+	{
+		Phase = EPhase::Finished;
+		return;
+	}
+	GrowPopulation(Populations[0]);
+}
+
+void AClimbingBenchmarkGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AClimbingBenchmarkGameMode::GenerateCliffs()
+{
+	//ground
+	SpawnBlock(FVector(0, 0, -50), FRotator::ZeroRotator, FVector(40000, 40000, 100));
+
+	const int32 CliffsPerRow = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt((float)NumCliffs)));
+	constexpr float CliffSpacing = 2500.f;
+	for (int32 CliffIndex = 0; CliffIndex < NumCliffs; CliffIndex++)
+	{
+		const FVector CliffBase((CliffIndex % CliffsPerRow) * CliffSpacing, (CliffIndex / CliffsPerRow) * CliffSpacing, 0);
+		const float Yaw = Random.FRandRange(0, 360);
+		const FRotator Facing(0, Yaw, 0);
+		const float Height = Random.FRandRange(400, 1600);
+		const float Width = Random.FRandRange(400, 1200);
+
+		//main face, tilted a little either way so it stays inside the climbable angle range
+		const FRotator WallRotation(Random.FRandRange(-12, 12), Yaw, 0);
+		SpawnBlock(CliffBase + FVector(0, 0, Height * 0.5f), WallRotation, FVector(300, Width, Height));
+
+		//a shelf halfway up to catch ledge checks
+		if (Random.FRand() < 0.6f)
+		{
+			const float LedgeHeight = Height * Random.FRandRange(0.3f, 0.7f);
+			SpawnBlock(CliffBase + Facing.RotateVector(FVector(-250, 0, LedgeHeight)), Facing, FVector(200, Width * 0.5f, 40));
+		}
+
+		//an overhang at the top, leaning out past the face
+		if (Random.FRand() < 0.4f)
+		{
+			const FRotator OverhangRotation(-Random.FRandRange(20, 40), Yaw, 0);
+			SpawnBlock(CliffBase + Facing.RotateVector(FVector(-200, 0, Height)), OverhangRotation, FVector(150, Width * 0.8f, 400));
+		}
+
+		const FVector WallFace = CliffBase + Facing.RotateVector(FVector(-150, 0, 0));
+		const FVector Home = CliffBase + Facing.RotateVector(FVector(-900, Random.FRandRange(-Width, Width) * 0.4f, 100));
+		ClimbRoutes.Emplace(Home, WallFace);
+	}
+}
+
+void AClimbingBenchmarkGameMode::SpawnBlock(const FVector& Location, const FRotator& Rotation, const FVector& SizeInCm)
+{
+	UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, ClimbingBenchmark::CubeMeshPath);
+
+	AStaticMeshActor* Block = GetWorld()->SpawnActor<AStaticMeshActor>(Location, Rotation);
+	UStaticMeshComponent* BlockMesh = Block->GetStaticMeshComponent();
+	//static components can't have their mesh changed while registered, and the cliffs have to stay static so they are never climbed as moving bases
+	BlockMesh->UnregisterComponent();
+	BlockMesh->SetStaticMesh(CubeMesh);
+	Block->SetActorScale3D(SizeInCm / ClimbingBenchmark::CubeSize);
+	BlockMesh->RegisterComponent();
+}
+
+void AClimbingBenchmarkGameMode::GrowPopulation(int32 TargetPopulation)
+{
+	MemoryBeforeGrowth = FPlatformMemory::GetStats().UsedPhysical;
+	const int32 NumAdded = TargetPopulation - Bots.Num();
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	while (Bots.Num() < TargetPopulation)
+	{
+		const TPair<FVector, FVector>& Route = ClimbRoutes[Bots.Num() % ClimbRoutes.Num()];
+		const FRotator Facing = (Route.Value - Route.Key).GetSafeNormal2D().Rotation();
+
+		AIslandAdventureGameCharacter* Bot = GetWorld()->SpawnActor<AIslandAdventureGameCharacter>(BotClass, Route.Key, Facing, SpawnParameters);
+		if (!Bot)
+			break;
+
+		Bot->AIControllerClass = AClimbingBotController::StaticClass();
+		Bot->SpawnDefaultController();
+		if (AClimbingBotController* BotController = Cast<AClimbingBotController>(Bot->GetController()))
+		{
+			BotController->SetClimbTarget(Route.Key, Route.Value, Seed + Bots.Num());
+		}
+		Bots.Add(Bot);
+	}
+
+	UE_LOG(LogClimbingBenchmark, Display, TEXT("Population %d: spawned %d bots, warming up"), Bots.Num(), NumAdded);
+	BytesPerCharacter = 0;
+	Phase = EPhase::WarmingUp;
+	PhaseTime = 0;
+}
+
+void AClimbingBenchmarkGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	PhaseTime += DeltaSeconds;
+	switch (Phase)
+	{
+	case EPhase::WarmingUp:
+		if (PhaseTime >= WarmUpSeconds)
+		{
+			//measured after warm up so lazily allocated per-character state is included
+			const int32 NumAdded = Bots.Num() - (PopulationIndex > 0 ? Populations[PopulationIndex - 1] : 0);
+			const int64 GrowthBytes = (int64)FPlatformMemory::GetStats().UsedPhysical - (int64)MemoryBeforeGrowth;
+			BytesPerCharacter = NumAdded > 0 ? GrowthBytes / NumAdded : 0;
+
+			FrameTimesMs.Reset();
+			QueriesAtSampleStart = CountSceneQueries();
+			Phase = EPhase::Sampling;
+			PhaseTime = 0;
+		}
+		break;
+
+	case EPhase::Sampling:
+		if (PhaseTime >= SampleSeconds)
+		{
+			FinishPopulation();
+		}
+		break;
+
+	case EPhase::Finished:
+		break;
+	}
+}
+
+void AClimbingBenchmarkGameMode::FinishPopulation()
+{
+	FPopulationResult& Result = Results.AddDefaulted_GetRef();
+	Result.Population = Bots.Num();
+	Result.Frames = FrameTimesMs.Num();
+	Result.BytesPerCharacter = BytesPerCharacter;
+	Result.QueriesPerFrame = Result.Frames > 0 ? (double)(CountSceneQueries() - QueriesAtSampleStart) / Result.Frames : 0;
+
+	FrameTimesMs.Sort();
+	Result.P50Ms = ClimbingBenchmark::Percentile(FrameTimesMs, 0.50);
+	Result.P95Ms = ClimbingBenchmark::Percentile(FrameTimesMs, 0.95);
+	Result.P99Ms = ClimbingBenchmark::Percentile(FrameTimesMs, 0.99);
+
+	UE_LOG(LogClimbingBenchmark, Display, TEXT("Population %d: p50 %.2fms p95 %.2fms p99 %.2fms, %.1f queries/frame, %lld bytes/character"),
+		Result.Population, Result.P50Ms, Result.P95Ms, Result.P99Ms, Result.QueriesPerFrame, Result.BytesPerCharacter);
+
+	PopulationIndex++;
+	if (Populations.IsValidIndex(PopulationIndex))
+	{
+		GrowPopulation(Populations[PopulationIndex]);
+		return;
+	}
+
+	Phase = EPhase::Finished;
+	WriteReport();
+	FPlatformMisc::RequestExit(false);
+}
+
+void AClimbingBenchmarkGameMode::WriteReport() const
+{
+	FString Csv = TEXT("Seed,Population,Frames,P50Ms,P95Ms,P99Ms,SceneQueriesPerFrame,BytesPerCharacter") LINE_TERMINATOR;
+	for (const FPopulationResult& Result : Results)
+	{
+		Csv += FString::Printf(TEXT("%d,%d,%d,%.3f,%.3f,%.3f,%.1f,%lld") LINE_TERMINATOR,
+			Seed, Result.Population, Result.Frames, Result.P50Ms, Result.P95Ms, Result.P99Ms, Result.QueriesPerFrame, Result.BytesPerCharacter);
+	}
+
+	const FString ReportPath = FPaths::ProfilingDir() / TEXT("ClimbingBenchmark.csv");
+	FFileHelper::SaveStringToFile(Csv, *ReportPath);
+	UE_LOG(LogClimbingBenchmark, Display, TEXT("Wrote climbing benchmark to %s"), *ReportPath);
+}
+
+uint32 AClimbingBenchmarkGameMode::CountSceneQueries() const
+{
+	uint32 NumQueries = 0;
+	for (const AIslandAdventureGameCharacter* Bot : Bots)
+	{
+		NumQueries += Bot->GetPlayerMovementComponent()->GetNumSceneQueries();
+	}
+	return NumQueries;
+}
+
+void AClimbingBenchmarkGameMode::OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld == GetWorld())
+	{
+		WorldTickStartSeconds = FPlatformTime::Seconds();
+	}
+}
+
+void AClimbingBenchmarkGameMode::OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	//world tick rather than whole frame, so rendering and idle time on a headless box don't skew it
+	if (InWorld == GetWorld() && Phase == EPhase::Sampling)
+	{
+		FrameTimesMs.Add((FPlatformTime::Seconds() - WorldTickStartSeconds) * 1000.0);
+	}
+}
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbingBotController.h"
+#include "IslandAdventureGameCharacter.h"
+#include "PlayerMovementComponent.h"
+
+AClimbingBotController::AClimbingBotController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+}
+
+void AClimbingBotController::SetClimbTarget(const FVector& InHomeLocation, const FVector& InWallLocation, int32 Seed)
+{
+	HomeLocation = InHomeLocation;
+	WallLocation = InWallLocation;
+	Random.Initialize(Seed);
+	//stagger the resets so the whole population doesn't teleport on the same frame
+	TimeSinceReset = Random.FRandRange(0, SecondsBeforeReset);
+}
+
+void AClimbingBotController::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	AIslandAdventureGameCharacter* Bot = Cast<AIslandAdventureGameCharacter>(GetPawn());
+	if (!Bot)
+		return;
+
+	UPlayerMovementComponent* Movement = Bot->GetPlayerMovementComponent();
+	TimeSinceReset += DeltaSeconds;
+	if (TimeSinceReset > SecondsBeforeReset)
+	{
+		SendHome();
+		return;
+	}
+
+	if (Movement->IsClimbing())
+	{
+		//same surface relative axes the character uses for player input
+		const FVector SurfaceNormal = Movement->GetClimbSurfaceNormal();
+		const FVector ClimbUp = FVector::CrossProduct(SurfaceNormal, -Bot->GetActorRightVector());
+		const FVector ClimbRight = FVector::CrossProduct(SurfaceNormal, Bot->GetActorUpVector());
+
+		Bot->AddMovementInput(ClimbUp, 1.f);
+		Bot->AddMovementInput(ClimbRight, FMath::Sin(TimeSinceReset) * 0.5f);
+
+		if (Random.FRand() < DeltaSeconds * ClimbDashesPerSecond)
+		{
+			Movement->TryClimbDashing();
+		}
+		return;
+	}
+
+	//walk at the wall and aim slightly up it, which is also where grapple targeting looks
+	const FVector ToWall = (WallLocation - Bot->GetActorLocation()).GetSafeNormal2D();
+	SetControlRotation(FRotator(15.f, ToWall.Rotation().Yaw, 0));
+	Bot->AddMovementInput(ToWall, 1.f);
+	Movement->TryClimbing();
+
+	if (Random.FRand() < DeltaSeconds * GrapplesPerSecond)
+	{
+		Movement->TryGrapple();
+	}
+}
+
+void AClimbingBotController::SendHome()
+{
+	APawn* Bot = GetPawn();
+	if (UPlayerMovementComponent* Movement = Cast<UPlayerMovementComponent>(Bot->GetMovementComponent()))
+	{
+		Movement->CancelClimbing();
+	}
+
+	const FVector ToWall = (WallLocation - HomeLocation).GetSafeNormal2D();
+	Bot->TeleportTo(HomeLocation, ToWall.Rotation());
+	TimeSinceReset = 0;
+}
@@ -0,0 +1,294 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbingPoseDatabase.h"
+#include "IslandAdventureGame.h"
+#include "PlayerMovementComponent.h"
+#include "Animation/AnimSequence.h"
+#include "Algo/Sort.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_CYCLE_STAT(TEXT("Climbing Pose Search"), STAT_ClimbingPoseSearch, STATGROUP_IslandAdventure);
+
+static_assert(FClimbingPoseQuery::NumFeatures == 8, "Points are stored as two FVector4f, update the scoring if the feature count changes");
+
+//squared distance between the query and a stored point, the query registers are loaded once per leaf
+static FORCEINLINE float ScorePoint(const FVector4f* Point, const VectorRegister4Float& Query0, const VectorRegister4Float& Query1)
+{
+	const VectorRegister4Float Delta0 = VectorSubtract(VectorLoad(&Point[0].X), Query0);
+	const VectorRegister4Float Delta1 = VectorSubtract(VectorLoad(&Point[1].X), Query1);
+	const VectorRegister4Float Sum = VectorMultiplyAdd(Delta1, Delta1, VectorMultiply(Delta0, Delta0));
+	return VectorGetComponent(VectorDot4(Sum, GlobalVectorConstants::FloatOne), 0);
+}
+
+#if WITH_EDITOR
+void UClimbingPoseDatabase::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	//resampling every clip while a slider is dragged is too slow, wait for the value to be committed
+	if (PropertyChangedEvent.ChangeType != EPropertyChangeType::Interactive)
+	{
+		BuildIndex();
+	}
+}
+#endif
+
+void UClimbingPoseDatabase::MakeFeatures(const FVector& LocalVelocity, const FVector& LocalNormal, const FVector& LocalDashDirection, float ContactRatio, float* OutFeatures) const
+{
+	//the weights are folded into the features so a plain squared distance is the weighted cost
+	const float VelocityScale = FMath::Sqrt(VelocityWeight) / ReferenceSpeed;
+	const float NormalScale = FMath::Sqrt(SurfaceNormalWeight);
+	const float DashScale = FMath::Sqrt(ClimbDashWeight);
+
+	OutFeatures[0] = LocalVelocity.X * VelocityScale;
+	OutFeatures[1] = LocalVelocity.Y * VelocityScale;
+	OutFeatures[2] = LocalVelocity.Z * VelocityScale;
+	//the normal always points back at the character, its sideways tilt and lean are what tell walls apart
+	OutFeatures[3] = LocalNormal.Y * NormalScale;
+	OutFeatures[4] = LocalNormal.Z * NormalScale;
+	OutFeatures[5] = LocalDashDirection.Y * DashScale;
+	OutFeatures[6] = LocalDashDirection.Z * DashScale;
+	OutFeatures[7] = ContactRatio * FMath::Sqrt(ContactWeight);
+}
+
+void UClimbingPoseDatabase::BuildIndex()
+{
+	const FQuat MeshRotation = MeshRelativeRotation.Quaternion();
+	const float SampleInterval = 1.f / SampleRate;
+
+	TArray<TArray<FClimbingPoseSample>> ClipSamples;
+	ClipSamples.SetNum(Clips.Num());
+	for (int32 ClipIndex = 0; ClipIndex < Clips.Num(); ClipIndex++)
+	{
+		const FClimbingPoseClip& Clip = Clips[ClipIndex];
+		if (!Clip.Sequence)
+			continue;
+
+		const FVector LocalNormal = Clip.SurfaceNormal.GetSafeNormal();
+		const float Length = Clip.Sequence->GetPlayLength();
+		const int32 NumSamples = FMath::FloorToInt32(Length * SampleRate) + 1;
+		for (int32 Frame = 0; Frame < NumSamples; Frame++)
+		{
+			const float Time = FMath::Min(Frame * SampleInterval, Length);
+			//velocity from the root motion around the sample, one sided at the clip ends
+			const float StartTime = FMath::Max(Time - SampleInterval * 0.5f, 0.f);
+			const float EndTime = FMath::Min(Time + SampleInterval * 0.5f, Length);
+			FVector LocalVelocity = FVector::ZeroVector;
+			if (EndTime > StartTime)
+			{
+				const FTransform RootMotion = Clip.Sequence->ExtractRootMotionFromRange(StartTime, EndTime, FAnimExtractContext());
+				LocalVelocity = MeshRotation.RotateVector(RootMotion.GetTranslation()) / (EndTime - StartTime);
+			}
+			const FVector LocalDashDirection = Clip.bIsClimbDash ? FVector(0, LocalVelocity.Y, LocalVelocity.Z).GetSafeNormal() : FVector::ZeroVector;
+
+			FClimbingPoseSample& Sample = ClipSamples[ClipIndex].AddDefaulted_GetRef();
+			MakeFeatures(LocalVelocity, LocalNormal, LocalDashDirection, Clip.ContactRatio, Sample.Features.Features);
+			Sample.Time = Time;
+		}
+	}
+
+	BuildIndexFromSamples(ClipSamples);
+}
+
+void UClimbingPoseDatabase::BuildIndexFromSamples(TConstArrayView<TArray<FClimbingPoseSample>> ClipSamples)
+{
+	Points.Reset();
+	Nodes.Reset();
+	PointClip.Reset();
+	PointTime.Reset();
+	ClipFirstSample.Reset();
+	SamplePoint.Reset();
+
+	TArray<FClimbingPoseQuery> Samples;
+	TArray<int32> SampleClip;
+	TArray<float> SampleTime;
+	for (int32 ClipIndex = 0; ClipIndex < ClipSamples.Num(); ClipIndex++)
+	{
+		ClipFirstSample.Add(Samples.Num());
+		for (const FClimbingPoseSample& Sample : ClipSamples[ClipIndex])
+		{
+			Samples.Add(Sample.Features);
+			SampleClip.Add(ClipIndex);
+			SampleTime.Add(Sample.Time);
+		}
+	}
+	ClipFirstSample.Add(Samples.Num());
+
+	if (Samples.Num() == 0)
+		return;
+
+	TArray<int32> Order;
+	Order.SetNumUninitialized(Samples.Num());
+	for (int32 Index = 0; Index < Order.Num(); Index++)
+	{
+		Order[Index] = Index;
+	}
+
+	Points.SetNumUninitialized(Samples.Num() * 2);
+	SamplePoint.SetNumUninitialized(Samples.Num());
+	Nodes.Reserve(2 * Samples.Num() / LeafSize + 1);
+	BuildNode(Order, 0, Order.Num(), Samples);
+
+	PointClip.SetNumUninitialized(Samples.Num());
+	PointTime.SetNumUninitialized(Samples.Num());
+	for (int32 Sample = 0; Sample < Samples.Num(); Sample++)
+	{
+		PointClip[SamplePoint[Sample]] = SampleClip[Sample];
+		PointTime[SamplePoint[Sample]] = SampleTime[Sample];
+	}
+
+	MarkPackageDirty();
+}
+
+int32 UClimbingPoseDatabase::BuildNode(TArray<int32>& Order, int32 Begin, int32 End, const TArray<FClimbingPoseQuery>& Samples)
+{
+	const int32 NodeIndex = Nodes.AddDefaulted();
+	Nodes[NodeIndex].Begin = Begin;
+	Nodes[NodeIndex].End = End;
+
+	if (End - Begin <= LeafSize)
+	{
+		//leaves own a contiguous run of points so scoring them streams through memory
+		for (int32 Index = Begin; Index < End; Index++)
+		{
+			const float* Features = Samples[Order[Index]].Features;
+			Points[Index * 2] = FVector4f(Features[0], Features[1], Features[2], Features[3]);
+			Points[Index * 2 + 1] = FVector4f(Features[4], Features[5], Features[6], Features[7]);
+			SamplePoint[Order[Index]] = Index;
+		}
+		return NodeIndex;
+	}
+
+	//split the widest spread dimension at its median
+	int32 SplitDimension = 0;
+	float BestVariance = -1;
+	for (int32 Dimension = 0; Dimension < FClimbingPoseQuery::NumFeatures; Dimension++)
+	{
+		float Sum = 0, SumSquared = 0;
+		for (int32 Index = Begin; Index < End; Index++)
+		{
+			const float Value = Samples[Order[Index]].Features[Dimension];
+			Sum += Value;
+			SumSquared += Value * Value;
+		}
+		const float Mean = Sum / (End - Begin);
+		const float Variance = SumSquared / (End - Begin) - Mean * Mean;
+		if (Variance > BestVariance)
+		{
+			BestVariance = Variance;
+			SplitDimension = Dimension;
+		}
+	}
+
+	const int32 Middle = Begin + (End - Begin) / 2;
+	TArrayView<int32> Range(Order.GetData() + Begin, End - Begin);
+	Algo::Sort(Range, [&Samples, SplitDimension](int32 A, int32 B) { return Samples[A].Features[SplitDimension] < Samples[B].Features[SplitDimension]; });
+
+	const float SplitValue = Samples[Order[Middle]].Features[SplitDimension];
+	const int32 Left = BuildNode(Order, Begin, Middle, Samples);
+	const int32 Right = BuildNode(Order, Middle, End, Samples);
+
+	//Nodes may have grown, don't hold a reference across the recursion
+	FClimbingPoseKDNode& Node = Nodes[NodeIndex];
+	Node.SplitDimension = SplitDimension;
+	Node.SplitValue = SplitValue;
+	Node.Left = Left;
+	Node.Right = Right;
+	return NodeIndex;
+}
+
+FClimbingPoseQuery UClimbingPoseDatabase::MakeQuery(const UPlayerMovementComponent& Movement) const
+{
+	const FQuat Rotation = Movement.UpdatedComponent ? Movement.UpdatedComponent->GetComponentQuat() : FQuat::Identity;
+	const FVector LocalDashDirection = Movement.IsClimbDashing() ? Rotation.UnrotateVector(Movement.GetClimbDashDirection()) : FVector::ZeroVector;
+
+	FClimbingPoseQuery Query;
+	MakeFeatures(Rotation.UnrotateVector(Movement.Velocity), Rotation.UnrotateVector(Movement.GetClimbSurfaceNormal()), LocalDashDirection, Movement.GetSurfaceProbeContactRatio(), Query.Features);
+	return Query;
+}
+
+bool UClimbingPoseDatabase::FindBestPose(const FClimbingPoseQuery& Query, int32 CurrentClip, float CurrentTime, int32& OutClip, float& OutTime) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbingPoseSearch);
+
+	if (Nodes.Num() == 0)
+		return false;
+
+	const VectorRegister4Float Query0 = VectorLoadAligned(Query.Features);
+	const VectorRegister4Float Query1 = VectorLoadAligned(Query.Features + 4);
+
+	//the pose that is playing sets the bar every other pose has to clear
+	int32 BestPoint = INDEX_NONE;
+	float BestCost = MAX_flt;
+	//INDEX_NONE means nothing is playing, and the index may be older than the clip list
+	const bool bCurrentClipIndexed = Clips.IsValidIndex(CurrentClip) && ClipFirstSample.IsValidIndex(CurrentClip + 1);
+	if (bCurrentClipIndexed)
+	{
+		const int32 FirstSample = ClipFirstSample[CurrentClip];
+		const int32 NumClipSamples = ClipFirstSample[CurrentClip + 1] - FirstSample;
+		if (NumClipSamples > 0)
+		{
+			const int32 Frame = FMath::Clamp(FMath::RoundToInt32(CurrentTime * SampleRate), 0, NumClipSamples - 1);
+			BestCost = FMath::Max(ScorePoint(&Points[SamplePoint[FirstSample + Frame] * 2], Query0, Query1) - ContinuingPoseBias, 0.f);
+		}
+	}
+
+	struct FPendingNode
+	{
+		int32 Node;
+		float MinCost;
+	};
+	TArray<FPendingNode, TInlineAllocator<64>> Stack;
+	Stack.Add({ 0, 0.f });
+
+	while (Stack.Num() > 0)
+	{
+		const FPendingNode Pending = Stack.Pop(EAllowShrinking::No);
+		if (Pending.MinCost >= BestCost)
+			continue;
+
+		const FClimbingPoseKDNode& Node = Nodes[Pending.Node];
+		if (Node.SplitDimension == INDEX_NONE)
+		{
+			for (int32 Index = Node.Begin; Index < Node.End; Index++)
+			{
+				const float Cost = ScorePoint(&Points[Index * 2], Query0, Query1);
+				if (Cost < BestCost)
+				{
+					BestCost = Cost;
+					BestPoint = Index;
+				}
+			}
+			continue;
+		}
+
+		//the near side goes on top so it is searched first and tightens the bound for the far side
+		const float Offset = Query.Features[Node.SplitDimension] - Node.SplitValue;
+		const bool bLeftIsNear = Offset < 0;
+		Stack.Add({ bLeftIsNear ? Node.Right : Node.Left, FMath::Max(Pending.MinCost, Offset * Offset) });
+		Stack.Add({ bLeftIsNear ? Node.Left : Node.Right, Pending.MinCost });
+	}
+
+	if (BestPoint == INDEX_NONE)
+	{
+		if (!bCurrentClipIndexed)
+			return false;
+
+		OutClip = CurrentClip;
+		OutTime = CurrentTime;
+		return true;
+	}
+
+	OutClip = PointClip[BestPoint];
+	OutTime = PointTime[BestPoint];
+	return true;
+}
+
+bool UClimbingPoseDatabase::FindClimbingPose(const UPlayerMovementComponent* Movement, int32 CurrentClip, float CurrentTime, int32& OutClip, float& OutTime) const
+{
+	if (!Movement)
+		return false;
+
+	return FindBestPose(MakeQuery(*Movement), CurrentClip, CurrentTime, OutClip, OutTime);
+}
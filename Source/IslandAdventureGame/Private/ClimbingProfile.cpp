@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbingProfile.h"
+#include "Curves/CurveFloat.h"
+
+void UClimbingProfile::PostInitProperties()
+{
+	Super::PostInitProperties();
+	RecomputeDerivedValues();
+}
+
+void UClimbingProfile::PostLoad()
+{
+	Super::PostLoad();
+	RecomputeDerivedValues();
+}
+
+#if WITH_EDITOR
+void UClimbingProfile::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	RecomputeDerivedValues();
+}
+#endif
+
+void UClimbingProfile::RecomputeDerivedValues()
+{
+	//acos falls as the angle grows, so "angle <= limit" becomes "dot >= cos(limit)" and the checks need no trig
+	CosMinSurfaceNormalAngle = FMath::Cos(FMath::DegreesToRadians(MinSurfaceNormalAngle));
+	CosMinClimbingAngle = FMath::Cos(FMath::DegreesToRadians(MinClimbingAngle));
+	CosMaxClimbingAngle = FMath::Cos(FMath::DegreesToRadians(MaxClimbingAngle));
+	CosMaxMeshWalkCreaseAngle = FMath::Cos(FMath::DegreesToRadians(MaxMeshWalkCreaseAngle));
+	InvMaxClimbingSpeed = MaxClimbingSpeed > 0 ? 1.f / MaxClimbingSpeed : 0.f;
+	ClimbDashAccelerationThreshold = MaxClimbingAcceleration / 10;
+	ClimbingEyeHeightOffset = ClimbingCollisionShrinkAmount / 3.0f;
+
+	ClimbDashSpeedSamples.Reset();
+	ClimbDashDuration = 0;
+	if (ClimbDashCurve)
+	{
+		float MinTime, MaxTime;
+		ClimbDashCurve->GetTimeRange(MinTime, MaxTime);
+		ClimbDashDuration = MaxTime;
+
+		//a new array rather than refilling the old one, the physics thread may still be reading it
+		TArray<float> Samples;
+		const int32 NumSamples = FMath::CeilToInt32(MaxTime * ClimbDashSampleRate) + 1;
+		Samples.Reserve(NumSamples);
+		for (int32 Index = 0; Index < NumSamples; Index++)
+		{
+			Samples.Add(ClimbDashCurve->GetFloatValue(Index / ClimbDashSampleRate));
+		}
+		ClimbDashSpeedSamples = MakeShared<const TArray<float>, ESPMode::ThreadSafe>(MoveTemp(Samples));
+	}
+}
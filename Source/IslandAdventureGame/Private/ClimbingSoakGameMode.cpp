@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbingSoakGameMode.h"
+#include "ClimbingSoakPlayerController.h"
+#include "IslandAdventureGameCharacter.h"
+#include "PlayerMovementComponent.h"
+#include "Engine/NetConnection.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerState.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogClimbingSoak, Log, All);
+
+namespace ClimbingSoak
+{
+	static double Percentile(const TArray<double>& SortedValues, double Fraction)
+	{
+		if (SortedValues.IsEmpty())
+			return 0;
+
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * SortedValues.Num()) - 1, 0, SortedValues.Num() - 1);
+		return SortedValues[Index];
+	}
+}
+
+AClimbingSoakGameMode::AClimbingSoakGameMode()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PlayerControllerClass = AClimbingSoakPlayerController::StaticClass();
+}
+
+void AClimbingSoakGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	ExpectedClients = FMath::Max(1, UGameplayStatics::GetIntOption(Options, TEXT("Clients"), ExpectedClients));
+	const FString SoakSecondsOption = UGameplayStatics::ParseOption(Options, TEXT("SoakSeconds"));
+	if (!SoakSecondsOption.IsEmpty())
+	{
+		SoakSeconds = FCString::Atof(*SoakSecondsOption);
+	}
+}
+
+void AClimbingSoakGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &AClimbingSoakGameMode::OnWorldTickStart);
+	//bound after the net driver, so this fires once replication for the frame has been sent
+	TickFlushHandle = GetWorld()->OnTickFlush().AddUObject(this, &AClimbingSoakGameMode::OnTickFlush);
+}
+
+void AClimbingSoakGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+	GetWorld()->OnTickFlush().Remove(TickFlushHandle);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AClimbingSoakGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	PhaseTime += DeltaSeconds;
+	switch (Phase)
+	{
+	case EPhase::WaitingForClients:
+		//settle only counts once everyone is in
+		if (GetNumPlayers() < ExpectedClients && PhaseTime < JoinTimeoutSeconds)
+		{
+			TimeSinceLastSample = 0;
+		}
+		else if ((TimeSinceLastSample += DeltaSeconds) >= SettleSeconds)
+		{
+			StartSoak();
+		}
+		break;
+
+	case EPhase::Soaking:
+		//the connection rates are recomputed once a second, sampling faster would only repeat them
+		TimeSinceLastSample += DeltaSeconds;
+		if (TimeSinceLastSample >= 1.f)
+		{
+			TimeSinceLastSample = 0;
+			SampleConnections();
+		}
+		if (PhaseTime >= SoakSeconds)
+		{
+			FinishSoak();
+		}
+		break;
+
+	case EPhase::Finished:
+		break;
+	}
+}
+
+void AClimbingSoakGameMode::StartSoak()
+{
+	Connections.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* Player = It->Get();
+		if (!Player || !Player->GetNetConnection())
+			continue;
+
+		FConnectionStats& Stats = Connections.AddDefaulted_GetRef();
+		Stats.Player = Player;
+		Stats.Name = Player->PlayerState ? Player->PlayerState->GetPlayerName() : Player->GetName();
+		Stats.CorrectionsAtStart = GetNumCorrections(Player);
+	}
+
+	UE_LOG(LogClimbingSoak, Display, TEXT("Soaking %d clients for %.0fs"), Connections.Num(), SoakSeconds);
+	FrameTimesMs.Reset();
+	Phase = EPhase::Soaking;
+	PhaseTime = 0;
+	TimeSinceLastSample = 0;
+}
+
+void AClimbingSoakGameMode::SampleConnections()
+{
+	for (FConnectionStats& Stats : Connections)
+	{
+		const APlayerController* Player = Stats.Player.Get();
+		const UNetConnection* Connection = Player ? Player->GetNetConnection() : nullptr;
+		if (!Connection)
+			continue;
+
+		Stats.Samples++;
+		Stats.OutBytesPerSecondSum += Connection->OutBytesPerSecond;
+		Stats.InBytesPerSecondSum += Connection->InBytesPerSecond;
+		Stats.PeakOutBytesPerSecond = FMath::Max(Stats.PeakOutBytesPerSecond, Connection->OutBytesPerSecond);
+		Stats.Corrections = GetNumCorrections(Player) - Stats.CorrectionsAtStart;
+	}
+}
+
+void AClimbingSoakGameMode::FinishSoak()
+{
+	SampleConnections();
+	Phase = EPhase::Finished;
+	WriteReport();
+	FPlatformMisc::RequestExit(false);
+}
+
+void AClimbingSoakGameMode::WriteReport() const
+{
+	TArray<double> SortedFrameTimes = FrameTimesMs;
+	SortedFrameTimes.Sort();
+	const double Minutes = FMath::Max(SoakSeconds / 60.0, UE_SMALL_NUMBER);
+
+	//one row per connection and a Server row with the totals, frame time only applies to the server
+	FString Csv = TEXT("Name,SecondsSampled,AvgOutBytesPerSec,PeakOutBytesPerSec,AvgInBytesPerSec,Corrections,CorrectionsPerMinute,FrameP50Ms,FrameP95Ms,FrameP99Ms") LINE_TERMINATOR;
+	double TotalOut = 0, TotalIn = 0;
+	int32 TotalPeakOut = 0;
+	uint32 TotalCorrections = 0;
+	for (const FConnectionStats& Stats : Connections)
+	{
+		const double AvgOut = Stats.Samples > 0 ? Stats.OutBytesPerSecondSum / Stats.Samples : 0;
+		const double AvgIn = Stats.Samples > 0 ? Stats.InBytesPerSecondSum / Stats.Samples : 0;
+		Csv += FString::Printf(TEXT("%s,%d,%.0f,%d,%.0f,%u,%.2f,,,") LINE_TERMINATOR,
+			*Stats.Name, Stats.Samples, AvgOut, Stats.PeakOutBytesPerSecond, AvgIn, Stats.Corrections, Stats.Corrections / Minutes);
+
+		TotalOut += AvgOut;
+		TotalIn += AvgIn;
+		TotalPeakOut += Stats.PeakOutBytesPerSecond;
+		TotalCorrections += Stats.Corrections;
+	}
+	Csv += FString::Printf(TEXT("Server,%.0f,%.0f,%d,%.0f,%u,%.2f,%.3f,%.3f,%.3f") LINE_TERMINATOR,
+		SoakSeconds, TotalOut, TotalPeakOut, TotalIn, TotalCorrections, TotalCorrections / Minutes,
+		ClimbingSoak::Percentile(SortedFrameTimes, 0.50), ClimbingSoak::Percentile(SortedFrameTimes, 0.95), ClimbingSoak::Percentile(SortedFrameTimes, 0.99));
+
+	const FString ReportPath = FPaths::ProfilingDir() / TEXT("ClimbingSoak.csv");
+	FFileHelper::SaveStringToFile(Csv, *ReportPath);
+	UE_LOG(LogClimbingSoak, Display, TEXT("Wrote soak report for %d clients to %s"), Connections.Num(), *ReportPath);
+}
+
+uint32 AClimbingSoakGameMode::GetNumCorrections(const APlayerController* Player)
+{
+	const AIslandAdventureGameCharacter* Character = Player ? Cast<AIslandAdventureGameCharacter>(Player->GetPawn()) : nullptr;
+	return Character ? Character->GetPlayerMovementComponent()->GetNumClientCorrections() : 0;
+}
+
+void AClimbingSoakGameMode::OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld == GetWorld())
+	{
+		WorldTickStartSeconds = FPlatformTime::Seconds();
+	}
+}
+
+void AClimbingSoakGameMode::OnTickFlush(float DeltaSeconds)
+{
+	//game and replication work for the frame, without the idle time the server spends waiting for its tick rate
+	if (Phase == EPhase::Soaking)
+	{
+		FrameTimesMs.Add((FPlatformTime::Seconds() - WorldTickStartSeconds) * 1000.0);
+	}
+}
@@ -0,0 +1,181 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbingSoakPlayerController.h"
+#include "IslandAdventureGameCharacter.h"
+#include "PlayerMovementComponent.h"
+#include "InputActionValue.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogClimbingSoakClient, Log, All);
+
+void AClimbingSoakPlayerController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!IsLocalController())
+		return;
+
+	int32 Seed = 0;
+	FParse::Value(FCommandLine::Get(), TEXT("SoakSeed="), Seed);
+	Random.Initialize(Seed);
+
+	FString ScriptPath;
+	if (FParse::Value(FCommandLine::Get(), TEXT("SoakScript="), ScriptPath) && !LoadRecordedScript(ScriptPath))
+	{
+		UE_LOG(LogClimbingSoakClient, Warning, TEXT("Could not read soak script %s, falling back to random play"), *ScriptPath);
+	}
+}
+
+bool AClimbingSoakPlayerController::LoadRecordedScript(const FString& Path)
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *Path))
+		return false;
+
+	for (const FString& Line : Lines)
+	{
+		if (Line.IsEmpty() || Line.StartsWith(TEXT("#")))
+			continue;
+
+		TArray<FString> Fields;
+		Line.ParseIntoArray(Fields, TEXT(","), false);
+		if (Fields.Num() < 2)
+			continue;
+
+		static const TMap<FString, ESoakAction> ActionNames = {
+			{ TEXT("Move"), ESoakAction::Move },
+			{ TEXT("Look"), ESoakAction::Look },
+			{ TEXT("Climb"), ESoakAction::Climb },
+			{ TEXT("CancelClimb"), ESoakAction::CancelClimb },
+			{ TEXT("ClimbDash"), ESoakAction::ClimbDash },
+			{ TEXT("Grapple"), ESoakAction::Grapple },
+		};
+		const ESoakAction* Action = ActionNames.Find(Fields[1].TrimStartAndEnd());
+		if (!Action)
+		{
+			UE_LOG(LogClimbingSoakClient, Warning, TEXT("Skipping soak step with unknown action: %s"), *Line);
+			continue;
+		}
+
+		FSoakStep& Step = RecordedSteps.AddDefaulted_GetRef();
+		Step.Seconds = FCString::Atof(*Fields[0]);
+		Step.Action = *Action;
+		Step.Value.X = Fields.IsValidIndex(2) ? FCString::Atof(*Fields[2]) : 0.f;
+		Step.Value.Y = Fields.IsValidIndex(3) ? FCString::Atof(*Fields[3]) : 0.f;
+	}
+
+	RecordedSteps.StableSort([](const FSoakStep& A, const FSoakStep& B) { return A.Seconds < B.Seconds; });
+	return RecordedSteps.Num() > 0;
+}
+
+void AClimbingSoakPlayerController::PlayerTick(float DeltaTime)
+{
+	Super::PlayerTick(DeltaTime);
+
+	AIslandAdventureGameCharacter* Character = Cast<AIslandAdventureGameCharacter>(GetPawn());
+	if (!Character)
+		return;
+
+	if (RecordedSteps.Num() > 0)
+	{
+		PlayRecordedScript(*Character, DeltaTime);
+	}
+	else
+	{
+		PlayRandomScript(*Character, DeltaTime);
+	}
+
+	//held axes are fed every frame, the same way Enhanced Input triggers them while a key is down
+	Character->Move(FInputActionValue(MoveValue));
+	Character->Look(FInputActionValue(LookValue * DeltaTime));
+}
+
+void AClimbingSoakPlayerController::PlayRecordedScript(AIslandAdventureGameCharacter& Character, float DeltaTime)
+{
+	ScriptTime += DeltaTime;
+	while (NextStep < RecordedSteps.Num() && RecordedSteps[NextStep].Seconds <= ScriptTime)
+	{
+		const FSoakStep& Step = RecordedSteps[NextStep++];
+		switch (Step.Action)
+		{
+		case ESoakAction::Move:
+			MoveValue = Step.Value;
+			break;
+		case ESoakAction::Look:
+			LookValue = Step.Value;
+			break;
+		default:
+			RunAction(Character, Step.Action);
+			break;
+		}
+	}
+
+	if (NextStep >= RecordedSteps.Num())
+	{
+		NextStep = 0;
+		ScriptTime = 0;
+	}
+}
+
+void AClimbingSoakPlayerController::PlayRandomScript(AIslandAdventureGameCharacter& Character, float DeltaTime)
+{
+	const UPlayerMovementComponent* Movement = Character.GetPlayerMovementComponent();
+	if (Movement->IsClimbing())
+	{
+		ClimbTime += DeltaTime;
+		MoveValue = FVector2D(FMath::Sin(ClimbTime) * 0.5f, 1.f);
+		LookValue = FVector2D::ZeroVector;
+
+		if (Random.FRand() < DeltaTime * ClimbDashesPerSecond)
+		{
+			RunAction(Character, ESoakAction::ClimbDash);
+		}
+		if (ClimbTime > MaxClimbSeconds)
+		{
+			RunAction(Character, ESoakAction::CancelClimb);
+		}
+		return;
+	}
+
+	//wander forward and turn every now and then, climbing whatever we walk into
+	ClimbTime = 0;
+	MoveValue = FVector2D(0, 1);
+	if (Random.FRand() < DeltaTime * TurnsPerSecond)
+	{
+		LookValue = FVector2D(Random.FRandRange(-90.f, 90.f), 0);
+	}
+	else if (Random.FRand() < DeltaTime)
+	{
+		LookValue = FVector2D::ZeroVector;
+	}
+
+	RunAction(Character, ESoakAction::Climb);
+	if (Random.FRand() < DeltaTime * GrapplesPerSecond)
+	{
+		RunAction(Character, ESoakAction::Grapple);
+	}
+}
+
+void AClimbingSoakPlayerController::RunAction(AIslandAdventureGameCharacter& Character, ESoakAction Action)
+{
+	switch (Action)
+	{
+	case ESoakAction::Climb:
+		Character.Climb();
+		break;
+	case ESoakAction::CancelClimb:
+		Character.CancelClimb();
+		break;
+	case ESoakAction::ClimbDash:
+		Character.ClimbDash();
+		break;
+	case ESoakAction::Grapple:
+		Character.Grapple();
+		break;
+	default:
+		break;
+	}
+}
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbingSolverMath.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogClimbingSolverMath, Log, All);
+
+#if !UE_BUILD_SHIPPING
+namespace ClimbingSolverMathBenchmark
+{
+	//a climber's worth of inputs, taken far from the world origin where large world coordinates matter
+	struct FSample
+	{
+		FVector Character;
+		FVector Surface;
+		FVector Forward;
+		FVector Normal;
+		FQuat Rotation;
+		float Speed;
+		FVector Probes[4];
+	};
+
+	struct FResult
+	{
+		double Seconds = 0;
+		//summed so the compiler can't drop the work
+		double Checksum = 0;
+	};
+
+	template<typename T>
+	static FResult Run(const TArray<FSample>& Samples, int32 Passes)
+	{
+		using FVectorT = UE::Math::TVector<T>;
+		using FQuatT = UE::Math::TQuat<T>;
+
+		//the profile's default snap and rotation speeds and max climbing speed, at 60Hz
+		const T DeltaTime = T(1) / T(60);
+		FResult Result;
+		const double StartSeconds = FPlatformTime::Seconds();
+		for (int32 Pass = 0; Pass < Passes; Pass++)
+		{
+			for (const FSample& Sample : Samples)
+			{
+				//the double path works on world positions as the solver used to, the float path relative to the surface
+				const FVector Origin = std::is_same_v<T, double> ? FVector::ZeroVector : Sample.Surface;
+				const FVectorT Probes[4] = { FVectorT(Sample.Probes[0] - Origin), FVectorT(Sample.Probes[1] - Origin), FVectorT(Sample.Probes[2] - Origin), FVectorT(Sample.Probes[3] - Origin) };
+				//the same kernel calls RunClimbingProbes, SnapToClimbingSurface and GetClimbingRotation make on each climbing substep
+				const FVectorT AssistNormals = FVectorT(Sample.Normal);
+				const FVectorT Normal = (AssistNormals + ClimbingSolverMath::CornerProbeNormal(Probes[0], Probes[1], Probes[2], Probes[3], AssistNormals)).GetSafeNormal();
+				const T SpeedScale = ClimbingSolverMath::SpeedScale(T(Sample.Speed), T(1) / T(120));
+				const FVectorT Offset = ClimbingSolverMath::SnapOffset(FVectorT(Sample.Surface - Sample.Character), FVectorT(Sample.Forward), Normal, T(45))
+					* ClimbingSolverMath::ConvergenceAlpha(T(4) * SpeedScale, DeltaTime);
+				const FQuatT Rotation = ClimbingSolverMath::ClimbingRotation(FQuatT(Sample.Rotation), Normal, ClimbingSolverMath::ConvergenceAlpha(T(6) * SpeedScale, DeltaTime));
+				Result.Checksum += Offset.X + Rotation.W;
+			}
+		}
+		Result.Seconds = FPlatformTime::Seconds() - StartSeconds;
+		return Result;
+	}
+
+	static void Benchmark(const TArray<FString>& Args)
+	{
+		const int32 NumSamples = 4096;
+		const int32 Passes = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 250;
+
+		FRandomStream Random(7);
+		TArray<FSample> Samples;
+		Samples.SetNum(NumSamples);
+		for (FSample& Sample : Samples)
+		{
+			const FVector WorldOffset = Random.GetUnitVector() * 2000000.0;
+			Sample.Normal = FVector(Random.FRandRange(-1, -0.6f), Random.FRandRange(-0.3f, 0.3f), Random.FRandRange(-0.3f, 0.3f)).GetSafeNormal();
+			Sample.Surface = WorldOffset;
+			Sample.Character = WorldOffset - Sample.Normal * Random.FRandRange(40, 60) + Random.GetUnitVector() * 5.0;
+			Sample.Forward = -Sample.Normal;
+			Sample.Rotation = FRotationMatrix::MakeFromX(Sample.Forward + Random.GetUnitVector() * 0.1).ToQuat();
+			Sample.Speed = Random.FRandRange(0, 300);
+			for (int32 Probe = 0; Probe < 4; Probe++)
+			{
+				Sample.Probes[Probe] = WorldOffset + FVector(0, (Probe & 1) ? 30 : -30, (Probe & 2) ? 40 : -40) + Random.GetUnitVector();
+			}
+		}
+
+		//warm the caches so the first run isn't penalised
+		Run<double>(Samples, 1);
+		Run<float>(Samples, 1);
+		const FResult Double = Run<double>(Samples, Passes);
+		const FResult Float = Run<float>(Samples, Passes);
+
+		const double Evaluations = (double)NumSamples * Passes;
+		UE_LOG(LogClimbingSolverMath, Display, TEXT("Climbing solver math over %.0f evaluations: double world %.1fns each, float local %.1fns each, %.2fx (checksums %.3f / %.3f)"),
+			Evaluations, Double.Seconds * 1e9 / Evaluations, Float.Seconds * 1e9 / Evaluations, Double.Seconds / FMath::Max(Float.Seconds, UE_SMALL_NUMBER), Double.Checksum, Float.Checksum);
+	}
+
+	static FAutoConsoleCommand BenchmarkCommand(
+		TEXT("IslandAdventure.Climbing.BenchmarkSolverMath"),
+		TEXT("Times the climbing solver kernels in world-space doubles against the float surface frame.\n")
+		TEXT("Optional argument: number of passes over the 4096 samples (default 250)"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&Benchmark));
+}
+#endif
@@ -0,0 +1,222 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnvironmentQueryCache.h"
+#include "IslandAdventureGame.h"
+#include "Engine/World.h"
+#include <atomic>
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Env Query Cache Hits"), STAT_EnvQueryCacheHits, STATGROUP_IslandAdventure);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Env Query Cache Misses"), STAT_EnvQueryCacheMisses, STATGROUP_IslandAdventure);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Env Query Cache Hit Rate %"), STAT_EnvQueryCacheHitRate, STATGROUP_IslandAdventure);
+
+#if STATS
+namespace EnvironmentQueryCacheStats
+{
+	//hit rate across every character this frame, wall probes for different characters can record from several threads at once
+	static std::atomic<uint64> Frame{ MAX_uint64 };
+	static std::atomic<uint32> FrameHits{ 0 };
+	static std::atomic<uint32> FrameQueries{ 0 };
+}
+#endif
+
+static bool ShapesMatch(const FCollisionShape& A, const FCollisionShape& B)
+{
+	return A.ShapeType == B.ShapeType && A.GetExtent().Equals(B.GetExtent(), KINDA_SMALL_NUMBER);
+}
+
+void FEnvironmentQueryCache::Init(UWorld* InWorld, ECollisionChannel InChannel, const FCollisionQueryParams* InQueryParams)
+{
+	World = InWorld;
+	Channel = InChannel;
+	QueryParams = InQueryParams;
+	CachedMultiHits.Reserve(32);
+	Invalidate();
+}
+
+void FEnvironmentQueryCache::Invalidate()
+{
+	CachedQueries.Reset();
+	NextEvictIndex = 0;
+	bHasCachedMulti = false;
+	CachedFrame = GFrameCounter;
+}
+
+void FEnvironmentQueryCache::BeginFrameIfNeeded()
+{
+	if (CachedFrame != GFrameCounter)
+	{
+		Invalidate();
+	}
+}
+
+bool FEnvironmentQueryCache::LineTrace(FHitResult& OutHit, const FVector& Start, const FVector& End)
+{
+	BeginFrameIfNeeded();
+
+	bool bBlockingHit = false;
+	if (FindContainingLineTrace(Start, End, OutHit, bBlockingHit))
+	{
+		RecordQuery(true);
+		return bBlockingHit;
+	}
+
+	RecordQuery(false);
+	UWorld* QueryWorld = World.Get();
+	bBlockingHit = QueryWorld && QueryWorld->LineTraceSingleByChannel(OutHit, Start, End, Channel, QueryParams ? *QueryParams : FCollisionQueryParams::DefaultQueryParam);
+
+	FCachedQuery Query;
+	Query.Start = Start;
+	Query.End = End;
+	Query.Rotation = FQuat::Identity;
+	Query.bIsLineTrace = true;
+	Query.bBlockingHit = bBlockingHit;
+	Query.Hit = OutHit;
+	Store(Query);
+	return bBlockingHit;
+}
+
+bool FEnvironmentQueryCache::Sweep(FHitResult& OutHit, const FVector& Start, const FVector& End, const FQuat& Rotation, const FCollisionShape& Shape)
+{
+	BeginFrameIfNeeded();
+
+	if (const FCachedQuery* Cached = FindSweep(Start, End, Rotation, Shape))
+	{
+		RecordQuery(true);
+		OutHit = Cached->Hit;
+		return Cached->bBlockingHit;
+	}
+
+	RecordQuery(false);
+	UWorld* QueryWorld = World.Get();
+	const bool bBlockingHit = QueryWorld && QueryWorld->SweepSingleByChannel(OutHit, Start, End, Rotation, Channel, Shape, QueryParams ? *QueryParams : FCollisionQueryParams::DefaultQueryParam);
+
+	FCachedQuery Query;
+	Query.Start = Start;
+	Query.End = End;
+	Query.Rotation = Rotation;
+	Query.Shape = Shape;
+	Query.bBlockingHit = bBlockingHit;
+	Query.Hit = OutHit;
+	Store(Query);
+	return bBlockingHit;
+}
+
+bool FEnvironmentQueryCache::SweepMulti(TArray<FHitResult>& OutHits, const FVector& Start, const FVector& End, const FQuat& Rotation, const FCollisionShape& Shape)
+{
+	BeginFrameIfNeeded();
+
+	if (bHasCachedMulti && CachedMultiStart.Equals(Start, KINDA_SMALL_NUMBER) && CachedMultiEnd.Equals(End, KINDA_SMALL_NUMBER)
+		&& CachedMultiRotation.Equals(Rotation, KINDA_SMALL_NUMBER) && ShapesMatch(CachedMultiShape, Shape))
+	{
+		RecordQuery(true);
+		OutHits.Reset();
+		OutHits.Append(CachedMultiHits);
+		return bCachedMultiBlockingHit;
+	}
+
+	RecordQuery(false);
+	UWorld* QueryWorld = World.Get();
+	const bool bBlockingHit = QueryWorld && QueryWorld->SweepMultiByChannel(OutHits, Start, End, Rotation, Channel, Shape, QueryParams ? *QueryParams : FCollisionQueryParams::DefaultQueryParam);
+
+	bHasCachedMulti = true;
+	bCachedMultiBlockingHit = bBlockingHit;
+	CachedMultiStart = Start;
+	CachedMultiEnd = End;
+	CachedMultiRotation = Rotation;
+	CachedMultiShape = Shape;
+	CachedMultiHits.Reset();
+	CachedMultiHits.Append(OutHits);
+	return bBlockingHit;
+}
+
+const FEnvironmentQueryCache::FCachedQuery* FEnvironmentQueryCache::FindSweep(const FVector& Start, const FVector& End, const FQuat& Rotation, const FCollisionShape& Shape) const
+{
+	for (const FCachedQuery& Cached : CachedQueries)
+	{
+		if (!Cached.bIsLineTrace && Cached.Start.Equals(Start, KINDA_SMALL_NUMBER) && Cached.End.Equals(End, KINDA_SMALL_NUMBER)
+			&& Cached.Rotation.Equals(Rotation, KINDA_SMALL_NUMBER) && ShapesMatch(Cached.Shape, Shape))
+		{
+			return &Cached;
+		}
+	}
+	return nullptr;
+}
+
+bool FEnvironmentQueryCache::FindContainingLineTrace(const FVector& Start, const FVector& End, FHitResult& OutHit, bool& bOutBlockingHit) const
+{
+	const FVector Delta = End - Start;
+	const double Length = Delta.Size();
+	if (Length <= KINDA_SMALL_NUMBER)
+		return false;
+
+	const FVector Direction = Delta / Length;
+
+	for (const FCachedQuery& Cached : CachedQueries)
+	{
+		if (!Cached.bIsLineTrace || !Cached.Start.Equals(Start, KINDA_SMALL_NUMBER))
+			continue;
+
+		const FVector CachedDelta = Cached.End - Cached.Start;
+		const double CachedLength = CachedDelta.Size();
+		if (CachedLength + KINDA_SMALL_NUMBER < Length || (CachedDelta / CachedLength | Direction) < 1 - KINDA_SMALL_NUMBER)
+			continue;
+
+		//same ray and at least as long, so the first blocking hit along our piece of it is the same one
+		if (Cached.bBlockingHit && Cached.Hit.Distance <= Length)
+		{
+			OutHit = Cached.Hit;
+			OutHit.TraceEnd = End;
+			OutHit.Time = Cached.Hit.Distance / Length;
+			bOutBlockingHit = true;
+		}
+		else
+		{
+			OutHit = FHitResult(Start, End);
+			bOutBlockingHit = false;
+		}
+		return true;
+	}
+	return false;
+}
+
+void FEnvironmentQueryCache::Store(const FCachedQuery& Query)
+{
+	if (CachedQueries.Num() < MaxCachedQueries)
+	{
+		CachedQueries.Add(Query);
+		return;
+	}
+
+	//full, overwrite the oldest rather than grow
+	CachedQueries[NextEvictIndex] = Query;
+	NextEvictIndex = (NextEvictIndex + 1) % MaxCachedQueries;
+}
+
+void FEnvironmentQueryCache::RecordQuery(bool bCacheHit)
+{
+	if (bCacheHit)
+	{
+		NumCacheHits++;
+		INC_DWORD_STAT(STAT_EnvQueryCacheHits);
+	}
+	else
+	{
+		NumQueriesIssued++;
+		INC_DWORD_STAT(STAT_EnvQueryCacheMisses);
+	}
+
+#if STATS
+	//no lock on the query path, the first query of a frame starts the counts over and one racing it may land in either frame
+	using namespace EnvironmentQueryCacheStats;
+	uint64 LastFrame = Frame.load(std::memory_order_relaxed);
+	if (LastFrame != GFrameCounter && Frame.compare_exchange_strong(LastFrame, GFrameCounter, std::memory_order_relaxed))
+	{
+		FrameHits.store(0, std::memory_order_relaxed);
+		FrameQueries.store(0, std::memory_order_relaxed);
+	}
+	const uint32 Hits = FrameHits.fetch_add(bCacheHit ? 1 : 0, std::memory_order_relaxed) + (bCacheHit ? 1 : 0);
+	const uint32 Queries = FrameQueries.fetch_add(1, std::memory_order_relaxed) + 1;
+	SET_FLOAT_STAT(STAT_EnvQueryCacheHitRate, 100.f * Hits / Queries);
+#endif
+}
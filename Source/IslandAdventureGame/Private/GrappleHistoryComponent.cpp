@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleHistoryComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+// Sets default values for this component's properties
+UGrappleHistoryComponent::UGrappleHistoryComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	//record where the mover ended up this frame, after physics and movement have run
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void UGrappleHistoryComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!ShouldRecord())
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	Record();
+}
+
+void UGrappleHistoryComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	Record();
+}
+
+bool UGrappleHistoryComponent::ShouldRecord() const
+{
+	//only the server validates grapples, clients have no use for the history
+	return GetOwner()->HasAuthority() && GetNetMode() != NM_Standalone;
+}
+
+void UGrappleHistoryComponent::SetPooled(bool bPooled)
+{
+	//a pooled owner is teleported on reuse, rewinding across that would put it back where it was parked
+	Head = INDEX_NONE;
+	NumSamples = 0;
+
+	const bool bRecord = !bPooled && ShouldRecord();
+	SetComponentTickEnabled(bRecord);
+	if (bRecord)
+	{
+		Record();
+	}
+}
+
+void UGrappleHistoryComponent::Record()
+{
+	const USceneComponent* Root = GetOwner()->GetRootComponent();
+	if (!Root)
+		return;
+
+	Head = (Head + 1) % HistorySize;
+	NumSamples = FMath::Min(NumSamples + 1, HistorySize);
+
+	FSample& Sample = Samples[Head];
+	Sample.Rotation = FQuat4f(Root->GetComponentQuat());
+	Sample.Location = FVector3f(Root->GetComponentLocation());
+	Sample.Time = GetWorld()->GetTimeSeconds();
+}
+
+bool UGrappleHistoryComponent::GetTransformAtTime(float Time, FTransform& OutTransform) const
+{
+	if (NumSamples == 0)
+		return false;
+
+	//walk back from the newest sample, rewinds are short so this only looks at a few entries
+	const FSample* Newer = &GetSample(0);
+	if (Time < Newer->Time)
+	{
+		for (int32 Age = 1; Age < NumSamples; Age++)
+		{
+			const FSample& Older = GetSample(Age);
+			if (Older.Time <= Time)
+			{
+				const float Alpha = (Time - Older.Time) / FMath::Max(Newer->Time - Older.Time, UE_SMALL_NUMBER);
+				OutTransform = FTransform(
+					FQuat(FQuat4f::Slerp(Older.Rotation, Newer->Rotation, Alpha)),
+					FVector(FMath::Lerp(Older.Location, Newer->Location, Alpha)));
+				return true;
+			}
+			Newer = &Older;
+		}
+	}
+
+	//past either end of the history, use the closest sample we have
+	OutTransform = FTransform(FQuat(Newer->Rotation), FVector(Newer->Location));
+	return true;
+}
+
+float UGrappleHistoryComponent::GetHistoryDuration() const
+{
+	return NumSamples > 0 ? GetSample(0).Time - GetSample(NumSamples - 1).Time : 0.f;
+}
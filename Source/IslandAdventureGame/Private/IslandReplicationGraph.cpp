@@ -0,0 +1,176 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "IslandReplicationGraph.h"
+#include "ActorAnchor.h"
+#include "Engine/LevelScriptActor.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/Info.h"
+#include "GameFramework/PlayerState.h"
+#include "UObject/UObjectIterator.h"
+
+void UIslandReplicationGraph::ResetGameWorldState()
+{
+	Super::ResetGameWorldState();
+
+	//the always relevant list holds actors from the old world, the grid clears itself
+	if (AlwaysRelevantNode)
+	{
+		AlwaysRelevantNode->NotifyResetAllNetworkActors();
+	}
+}
+
+void UIslandReplicationGraph::SetClassPolicy(UClass* Class, EIslandClassRepNodeMapping Mapping)
+{
+	ClassRepNodePolicies.Set(Class, Mapping);
+}
+
+EIslandClassRepNodeMapping UIslandReplicationGraph::GetMappingPolicy(const UClass* Class) const
+{
+	const EIslandClassRepNodeMapping* Mapping = ClassRepNodePolicies.Get(Class);
+	return Mapping ? *Mapping : EIslandClassRepNodeMapping::NotRouted;
+}
+
+void UIslandReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	//classes we route by hand, everything else is worked out from its defaults below
+	SetClassPolicy(AReplicationGraphDebugActor::StaticClass(), EIslandClassRepNodeMapping::NotRouted);
+	SetClassPolicy(ALevelScriptActor::StaticClass(), EIslandClassRepNodeMapping::NotRouted);
+	//anchors stay where they were fired and can outlive a character leaving the grid cells they are in, so they are gridded like any mover
+	SetClassPolicy(AActorAnchor::StaticClass(), EIslandClassRepNodeMapping::Spatialize_Dynamic);
+	SetClassPolicy(APlayerState::StaticClass(), EIslandClassRepNodeMapping::RelevantAllConnections);
+	SetClassPolicy(AGameStateBase::StaticClass(), EIslandClassRepNodeMapping::RelevantAllConnections);
+	SetClassPolicy(ACharacter::StaticClass(), EIslandClassRepNodeMapping::Spatialize_Dynamic);
+
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		UClass* Class = *It;
+		const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject(false));
+		if (!ActorCDO || !ActorCDO->GetIsReplicated())
+			continue;
+
+		//skip blueprint compilation leftovers
+		if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_")))
+			continue;
+
+		if (!ClassRepNodePolicies.Contains(Class, false))
+		{
+			EIslandClassRepNodeMapping Mapping = EIslandClassRepNodeMapping::Spatialize_Dynamic;
+			if (ActorCDO->bOnlyRelevantToOwner)
+			{
+				//player controllers and the like, gathered by each connection's own node
+				Mapping = EIslandClassRepNodeMapping::NotRouted;
+			}
+			else if (ActorCDO->bAlwaysRelevant)
+			{
+				Mapping = EIslandClassRepNodeMapping::RelevantAllConnections;
+			}
+			else if (ActorCDO->NetDormancy > DORM_Awake)
+			{
+				Mapping = EIslandClassRepNodeMapping::Spatialize_Dormancy;
+			}
+			else if (ActorCDO->GetRootComponent() && ActorCDO->GetRootComponent()->Mobility == EComponentMobility::Static)
+			{
+				Mapping = EIslandClassRepNodeMapping::Spatialize_Static;
+			}
+			SetClassPolicy(Class, Mapping);
+		}
+
+		FClassReplicationInfo ClassInfo;
+		ClassInfo.SetCullDistanceSquared(ActorCDO->NetCullDistanceSquared);
+		ClassInfo.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(ActorCDO->NetUpdateFrequency);
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+	}
+}
+
+void UIslandReplicationGraph::InitGlobalGraphNodes()
+{
+	Super::InitGlobalGraphNodes();
+
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = GridCellSize;
+	GridNode->SpatialBias = GridSpatialBias;
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UIslandReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	//the connection's own controller and whatever it is viewing through
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(ConnectionNode, RepGraphConnection);
+}
+
+void UIslandReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+	case EIslandClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+	case EIslandClassRepNodeMapping::Spatialize_Static:
+		GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+		break;
+	case EIslandClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+	case EIslandClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+	default:
+		break;
+	}
+}
+
+void UIslandReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+	case EIslandClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+	case EIslandClassRepNodeMapping::Spatialize_Static:
+		GridNode->RemoveActor_Static(ActorInfo);
+		break;
+	case EIslandClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+	case EIslandClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+	default:
+		break;
+	}
+}
+
+void UIslandReplicationGraph::SetClimbingReplication(ACharacter* Character, bool bIsClimbing)
+{
+	const UNetDriver* NetDriver = Character ? Character->GetNetDriver() : nullptr;
+	UIslandReplicationGraph* Graph = NetDriver ? Cast<UIslandReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr;
+	if (!Graph)
+		return;
+
+	//the per actor settings start as a copy of the class settings, so leaving the climb restores the class rate
+	FGlobalActorReplicationInfo& GlobalInfo = Graph->GlobalActorReplicationInfoMap.Get(Character);
+	const uint32 ReplicationPeriodFrame = bIsClimbing
+		? Graph->ClimbingReplicationPeriodFrame
+		: Graph->GlobalActorReplicationInfoMap.GetClassInfo(Character->GetClass()).ReplicationPeriodFrame;
+	GlobalInfo.Settings.ReplicationPeriodFrame = ReplicationPeriodFrame;
+
+	//connections copy the settings when they first see the actor and replicate at their own copy's rate from then on
+	for (UNetReplicationGraphConnection* Connection : Graph->Connections)
+	{
+		if (FConnectionReplicationActorInfo* ConnectionInfo = Connection->ActorInfoMap.Find(Character))
+		{
+			ConnectionInfo->ReplicationPeriodFrame = ReplicationPeriodFrame;
+		}
+	}
+}
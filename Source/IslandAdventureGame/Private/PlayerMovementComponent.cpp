@@ -5,7 +5,29 @@
 #include <Kismet/KismetSystemLibrary.h>
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/Character.h"
+#include "GameFramework/Controller.h"
 #include "UObject/ObjectMacros.h"
+#include "HAL/IConsoleManager.h"
+#include "ClimbingAsyncSubsystem.h"
+#include "GrappleHistoryComponent.h"
+#include "IslandReplicationGraph.h"
+#include "ClimbingSolverMath.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+
+LLM_DEFINE_TAG(ClimbingMovement);
+
+namespace PlayerMovementCVars
+{
+	static int32 DrawClimbingDebug = 0;
+	static FAutoConsoleVariableRef CVarDrawClimbingDebug(
+		TEXT("IslandAdventure.Climbing.DrawDebug"),
+		DrawClimbingDebug,
+		TEXT("Draw the climbing and grapple probes.\n")
+		TEXT("0: Disable, 1: Enable"),
+		ECVF_Cheat);
+}
 
 UENUM(BlueprintType)
 enum ECustomMovementMode
@@ -15,38 +37,422 @@ enum ECustomMovementMode
 	CMOVE_MAX			UMETA(Hidden),
 };
 
+UPlayerMovementComponent::UPlayerMovementComponent()
+{
+	//the sweep only reads the scene and writes this component's hit storage, and nothing touches either until movement runs
+	WallProbeTick.bCanEverTick = true;
+	WallProbeTick.bStartWithTickEnabled = true;
+	WallProbeTick.bRunOnAnyThread = true;
+	WallProbeTick.TickGroup = TG_PrePhysics;
+
+	//camera managers update between TG_PostPhysics and TG_PostUpdateWork, so this aims from where the camera ended up this frame
+	GrappleTargetingTick.bCanEverTick = true;
+	GrappleTargetingTick.bStartWithTickEnabled = true;
+	GrappleTargetingTick.bAllowTickOnDedicatedServer = false;
+	GrappleTargetingTick.TickGroup = TG_PostUpdateWork;
+}
+
+void FPlayerMovementWallProbeTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && Target->IsRegistered() && !Target->IsUnreachable())
+	{
+		Target->TickWallProbe();
+	}
+}
+
+FString FPlayerMovementWallProbeTickFunction::DiagnosticMessage()
+{
+	return Target->GetFullName() + TEXT("[UPlayerMovementComponent::WallProbe]");
+}
+
+FName FPlayerMovementWallProbeTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return Target->GetClass()->GetFName();
+}
+
+void FPlayerMovementGrappleTargetingTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && Target->IsRegistered() && !Target->IsUnreachable())
+	{
+		Target->TickGrappleTargeting();
+	}
+}
+
+FString FPlayerMovementGrappleTargetingTickFunction::DiagnosticMessage()
+{
+	return Target->GetFullName() + TEXT("[UPlayerMovementComponent::GrappleTargeting]");
+}
+
+FName FPlayerMovementGrappleTargetingTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return Target->GetClass()->GetFName();
+}
+
 void UPlayerMovementComponent::TryGrapple()
 {
 	if (!bCanGrapple)
 		return;
 
-	CurrentAnchor = GetWorld()->SpawnActor<AActorAnchor>(Anchor);
+	//clients get a local copy for feedback straight away, the server spawns the real one once it accepts the request
+	SpawnAnchor();
+
+	if (!CharacterOwner->HasAuthority())
+	{
+		//the server rewinds moving targets to this time, the server time of the snapshot the client is drawing rather than the server's time now
+		const AGameStateBase* GameState = GetWorld()->GetGameState();
+		ServerRequestGrapple(LastValidGrapplePoint, ActorToGrapple, GameState ? GameState->GetServerWorldTimeSeconds() - GrappleTargetInterpolationDelay : 0.f);
+	}
+}
+
+void UPlayerMovementComponent::SpawnAnchor()
+{
+	if (!Anchor)
+		return;
+
+	//only one anchor per character, grappling again replaces it
+	if (IsValid(CurrentAnchor))
+	{
+		CurrentAnchor->Destroy();
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Owner = CharacterOwner;
+	CurrentAnchor = GetWorld()->SpawnActor<AActorAnchor>(Anchor, SpawnParameters);
 	CurrentAnchor->InitAnchor(LastValidGrapplePoint, ActorToGrapple);
+
+	//the client's copy is only there to look right until the server answers, it never collides with anything
+	if (!CharacterOwner->HasAuthority())
+	{
+		CurrentAnchor->SetReplicates(false);
+		CurrentAnchor->SetActorEnableCollision(false);
+	}
+}
+
+void UPlayerMovementComponent::ClientGrappleRejected_Implementation()
+{
+	if (IsValid(CurrentAnchor))
+	{
+		CurrentAnchor->Destroy();
+	}
+	CurrentAnchor = nullptr;
+}
+
+void UPlayerMovementComponent::ServerRequestGrapple_Implementation(FVector_NetQuantize GrapplePoint, AActor* GrappleTarget, float ClientTimeStamp)
+{
+	if (!IsValidGrappleRequest(GrapplePoint, GrappleTarget, ClientTimeStamp))
+	{
+		ClientGrappleRejected();
+		return;
+	}
+
+	LastValidGrapplePoint = GrapplePoint;
+	ActorToGrapple = GrappleTarget;
+	SpawnAnchor();
+}
+
+bool UPlayerMovementComponent::IsValidGrappleRequest(const FVector& GrapplePoint, const AActor* GrappleTarget, float ClientTimeStamp) const
+{
+	//the client aims from its camera, which can sit behind the character, so the camera distance is allowed on top of the grapple range
+	const FVector EyeLocation = CharacterOwner->GetPawnViewLocation();
+	const float MaxRange = GrappleRaycastStartOffset + GrappleDistance + MaxGrappleCameraDistance;
+	if (FVector::DistSquared(EyeLocation, GrapplePoint) > FMath::Square(MaxRange))
+	{
+		return false;
+	}
+
+	//targets that keep a history are checked where the client saw them, the timestamp is clamped so a client can't reach far into the past
+	const UGrappleHistoryComponent* TargetHistory = IsValid(GrappleTarget) ? GrappleTarget->FindComponentByClass<UGrappleHistoryComponent>() : nullptr;
+	if (TargetHistory)
+	{
+		const float Now = GetWorld()->GetTimeSeconds();
+		return IsValidRewoundGrappleRequest(GrapplePoint, *TargetHistory, FMath::Clamp(ClientTimeStamp, Now - MaxGrappleRewindTime, Now));
+	}
+
+	//one ray from the character, running a little past the claimed point, has to land on the claimed actor near that point
+	const FVector RayDirection = (GrapplePoint - EyeLocation).GetSafeNormal();
+	FHitResult Hit;
+	if (!ClimbingLineTrace(Hit, EyeLocation, GrapplePoint + RayDirection * GrappleValidationTolerance))
+	{
+		return false;
+	}
+
+	return Hit.GetActor() == GrappleTarget && FVector::DistSquared(Hit.ImpactPoint, GrapplePoint) <= FMath::Square(GrappleValidationTolerance);
+}
+
+bool UPlayerMovementComponent::IsValidRewoundGrappleRequest(const FVector& GrapplePoint, const UGrappleHistoryComponent& TargetHistory, float RewindTime) const
+{
+	const AActor* GrappleTarget = TargetHistory.GetOwner();
+	FTransform TargetThen;
+	if (!TargetHistory.GetTransformAtTime(RewindTime, TargetThen))
+	{
+		return false;
+	}
+
+	//the client fires from where it is now, only the target is seen late
+	const FVector EyeLocation = CharacterOwner->GetPawnViewLocation();
+	const FVector RayDirection = (GrapplePoint - EyeLocation).GetSafeNormal();
+
+	//nothing else may stand between us and the rewound point, the target itself is left out since it has moved on since then
+	FCollisionQueryParams OcclusionQueryParams = ClimbingQueryParameters;
+	OcclusionQueryParams.AddIgnoredActor(GrappleTarget);
+	FHitResult OcclusionHit;
+	if (GetWorld()->LineTraceSingleByChannel(OcclusionHit, EyeLocation, GrapplePoint - RayDirection * GrappleValidationTolerance, ECC_WorldStatic, OcclusionQueryParams))
+	{
+		return false;
+	}
+
+	//rather than moving the target back, carry the ray into the target's frame as it was then and out again at its current pose,
+	//then test only the target, so nothing in the scene has to be moved
+	const FTransform& TargetNow = GrappleTarget->GetActorTransform();
+	TargetThen.SetScale3D(TargetNow.GetScale3D());
+	const FVector RayStart = TargetNow.TransformPosition(TargetThen.InverseTransformPosition(EyeLocation));
+	const FVector RayEnd = TargetNow.TransformPosition(TargetThen.InverseTransformPosition(GrapplePoint + RayDirection * GrappleValidationTolerance));
+
+	FHitResult Hit;
+	if (!GrappleTarget->ActorLineTraceSingle(Hit, RayStart, RayEnd, ECC_WorldStatic, ClimbingQueryParameters))
+	{
+		return false;
+	}
+
+	return FVector::DistSquared(TargetThen.TransformPosition(TargetNow.InverseTransformPosition(Hit.ImpactPoint)), GrapplePoint) <= FMath::Square(GrappleValidationTolerance);
+}
+
+void UPlayerMovementComponent::PostLoad()
+{
+	Super::PostLoad();
+	MigrateDeprecatedClimbingTuning();
+}
+
+void UPlayerMovementComponent::MigrateDeprecatedClimbingTuning()
+{
+	//components that already have a profile, or never overrode the old defaults, have nothing to move
+	const UClimbingProfile& Defaults = *GetDefault<UClimbingProfile>();
+	const bool bHasOverrides = ClimbDashCurve_DEPRECATED != nullptr
+		|| CollisionCapsuleRadius_DEPRECATED != Defaults.CollisionCapsuleRadius
+		|| CollisionCapsuleHalfHeight_DEPRECATED != Defaults.CollisionCapsuleHalfHeight
+		|| MinSurfaceNormalAngle_DEPRECATED != Defaults.MinSurfaceNormalAngle
+		|| MinClimbingAngle_DEPRECATED != Defaults.MinClimbingAngle
+		|| MaxClimbingAngle_DEPRECATED != Defaults.MaxClimbingAngle
+		|| ClimbingCollisionShrinkAmount_DEPRECATED != Defaults.ClimbingCollisionShrinkAmount
+		|| MaxClimbingSpeed_DEPRECATED != Defaults.MaxClimbingSpeed
+		|| MaxClimbingAcceleration_DEPRECATED != Defaults.MaxClimbingAcceleration
+		|| ClimbingDeceleration_DEPRECATED != Defaults.ClimbingDeceleration
+		|| ClimbingRotationSpeed_DEPRECATED != Defaults.ClimbingRotationSpeed
+		|| ClimbingSnapSpeed_DEPRECATED != Defaults.ClimbingSnapSpeed
+		|| DistanceFromSurface_DEPRECATED != Defaults.DistanceFromSurface
+		|| FloorCheckDistance_DEPRECATED != Defaults.FloorCheckDistance
+		|| MinClimbDownThreshold_DEPRECATED != Defaults.MinClimbDownThreshold
+		|| MinClimbLedgeThreshold_DEPRECATED != Defaults.MinClimbLedgeThreshold;
+	if (ClimbingProfile || !bHasOverrides)
+	{
+		return;
+	}
+
+	//public so placed instances can keep pointing at the one made for their archetype
+	UClimbingProfile* MigratedProfile = NewObject<UClimbingProfile>(this, TEXT("MigratedClimbingProfile"), RF_Public);
+	MigratedProfile->CollisionCapsuleRadius = CollisionCapsuleRadius_DEPRECATED;
+	MigratedProfile->CollisionCapsuleHalfHeight = CollisionCapsuleHalfHeight_DEPRECATED;
+	MigratedProfile->MinSurfaceNormalAngle = MinSurfaceNormalAngle_DEPRECATED;
+	MigratedProfile->MinClimbingAngle = MinClimbingAngle_DEPRECATED;
+	MigratedProfile->MaxClimbingAngle = MaxClimbingAngle_DEPRECATED;
+	MigratedProfile->ClimbingCollisionShrinkAmount = ClimbingCollisionShrinkAmount_DEPRECATED;
+	MigratedProfile->MaxClimbingSpeed = MaxClimbingSpeed_DEPRECATED;
+	MigratedProfile->MaxClimbingAcceleration = MaxClimbingAcceleration_DEPRECATED;
+	MigratedProfile->ClimbingDeceleration = ClimbingDeceleration_DEPRECATED;
+	MigratedProfile->ClimbingRotationSpeed = ClimbingRotationSpeed_DEPRECATED;
+	MigratedProfile->ClimbingSnapSpeed = ClimbingSnapSpeed_DEPRECATED;
+	MigratedProfile->DistanceFromSurface = DistanceFromSurface_DEPRECATED;
+	MigratedProfile->FloorCheckDistance = FloorCheckDistance_DEPRECATED;
+	MigratedProfile->MinClimbDownThreshold = MinClimbDownThreshold_DEPRECATED;
+	MigratedProfile->MinClimbLedgeThreshold = MinClimbLedgeThreshold_DEPRECATED;
+	MigratedProfile->ClimbDashCurve = ClimbDashCurve_DEPRECATED;
+	MigratedProfile->RecomputeDerivedValues();
+	ClimbingProfile = MigratedProfile;
 }
 
 void UPlayerMovementComponent::BeginPlay()
 {
+	LLM_SCOPE_BYTAG(ClimbingMovement);
+
 	Super::BeginPlay();
+	//the sweep writes every overlap before we truncate, so leave headroom for cluttered walls
+	CurrentWallHits.Reserve(MaxWallHits * 4);
 	//ignores the character for the sweep check
 	ClimbingQueryParameters.AddIgnoredActor(GetOwner());
-	RaycastLocations = CharacterOwner->GetCapsuleComponent()->GetAttachChildren();
-	while (RaycastLocations.Num() > 4)
-	{
-		RaycastLocations.RemoveAt(0);
-	}
+	QueryCache.Init(GetWorld(), ECC_WorldStatic, &ClimbingQueryParameters);
+	CharacterOwner->ReceiveControllerChangedDelegate.AddUniqueDynamic(this, &UPlayerMovementComponent::OnControllerChanged);
+	OnControllerChanged(CharacterOwner, nullptr, CharacterOwner->GetController());
+	GetCornerProbeComponents(*CharacterOwner, RaycastLocations);
 	/*for (USceneComponent* component : RaycastLocations)
 	{
 		GEngine->AddOnScreenDebugMessage(-1, 10, FColor::White, TEXT(""+(component->GetName())+ " " + (component->GetComponentLocation().ToString())));
 	}*/
 }
 
+void UPlayerMovementComponent::OnUnregister()
+{
+	ReleaseAsyncClimbingSlot();
+	Super::OnUnregister();
+}
+
 void UPlayerMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	LLM_SCOPE_BYTAG(ClimbingMovement);
+
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	SweepAndStoreWallHits();
-	CheckForGrapplePoint();
+#if !UE_BUILD_SHIPPING
+	if (HasValidData() && CharacterOwner->GetLocalRole() != ROLE_SimulatedProxy)
+	{
+		VerifyNoScratchReallocation();
+	}
+#endif
+}
+
+void UPlayerMovementComponent::RegisterComponentTickFunctions(bool bRegister)
+{
+	Super::RegisterComponentTickFunctions(bRegister);
+
+	if (bRegister)
+	{
+		if (SetupActorComponentTickFunction(&WallProbeTick))
+		{
+			WallProbeTick.Target = this;
+			//a Blueprint tick on the character can start a climb, which reads the wall hits
+			WallProbeTick.AddPrerequisite(GetOwner(), GetOwner()->PrimaryActorTick);
+			PrimaryComponentTick.AddPrerequisite(this, WallProbeTick);
+		}
+		if (SetupActorComponentTickFunction(&GrappleTargetingTick))
+		{
+			GrappleTargetingTick.Target = this;
+			GrappleTargetingTick.AddPrerequisite(this, PrimaryComponentTick);
+		}
+	}
+	else
+	{
+		if (WallProbeTick.IsTickFunctionRegistered())
+		{
+			PrimaryComponentTick.RemovePrerequisite(this, WallProbeTick);
+			WallProbeTick.UnRegisterTickFunction();
+		}
+		if (GrappleTargetingTick.IsTickFunctionRegistered())
+		{
+			GrappleTargetingTick.UnRegisterTickFunction();
+		}
+	}
+}
+
+void UPlayerMovementComponent::SetComponentTickEnabled(bool bEnabled)
+{
+	Super::SetComponentTickEnabled(bEnabled);
+
+	//the probe and targeting stages only make sense around the movement tick
+	if (!IsTemplate())
+	{
+		WallProbeTick.SetTickFunctionEnable(bEnabled);
+		GrappleTargetingTick.SetTickFunctionEnable(bEnabled);
+	}
+}
+
+void UPlayerMovementComponent::TickWallProbe()
+{
+	LLM_SCOPE_BYTAG(ClimbingMovement);
+
+	//simulated proxies never run PhysClimbing, they just follow the replicated movement
+	if (!HasValidData() || CharacterOwner->GetLocalRole() == ROLE_SimulatedProxy)
+		return;
+
+	//the server only needs wall data for remote players while they climb, climb requests sweep for themselves
+	//climbing on a moving base sweeps from PhysClimbing once the base has moved, a sweep from here would be a frame behind it
+	const bool bClimbingOnBase = IsClimbing() && CharacterOwner->GetMovementBase();
+	const bool bClimbingOnMesh = IsClimbing() && SurfaceWalker.IsAttached();
+	bSurfaceProbedThisFrame = false;
+	if ((CharacterOwner->IsLocallyControlled() || IsClimbing()) && !bClimbingOnBase && !bClimbingOnMesh)
+	{
+		//the surface probes follow up on the wall hits, so climbers make them here too instead of on the game thread
+		bSurfaceProbedThisFrame = IsClimbing();
+		RunClimbingProbes(bSurfaceProbedThisFrame ? EClimbingProbes::WallAndSurface : EClimbingProbes::Wall);
+	}
+}
+
+void UPlayerMovementComponent::TickGrappleTargeting()
+{
+	LLM_SCOPE_BYTAG(ClimbingMovement);
+
+	//grapple targeting is driven by whoever is aiming, remote players send their target with the request
+	if (HasValidData() && CharacterOwner->IsLocallyControlled())
+	{
+		CheckForGrapplePoint();
+	}
+}
+
+void UPlayerMovementComponent::OnControllerChanged(APawn* Pawn, AController* OldController, AController* NewController)
+{
+	if (OldController)
+	{
+		WallProbeTick.RemovePrerequisite(OldController, OldController->PrimaryActorTick);
+	}
+	if (APlayerCameraManager* OldCameraManager = GrappleCameraManager.Get())
+	{
+		GrappleTargetingTick.RemovePrerequisite(OldCameraManager, OldCameraManager->PrimaryActorTick);
+	}
+	GrappleCameraManager = nullptr;
+
+	if (!NewController)
+		return;
+
+	//input is handled on the controller's tick and can start a climb, so the probe waits for it the same way movement does
+	WallProbeTick.AddPrerequisite(NewController, NewController->PrimaryActorTick);
+
+	const APlayerController* PlayerController = Cast<APlayerController>(NewController);
+	if (PlayerController && PlayerController->PlayerCameraManager)
+	{
+		GrappleCameraManager = PlayerController->PlayerCameraManager;
+		GrappleTargetingTick.AddPrerequisite(PlayerController->PlayerCameraManager, PlayerController->PlayerCameraManager->PrimaryActorTick);
+	}
+}
+
+bool UPlayerMovementComponent::ClimbingLineTrace(FHitResult& OutHit, const FVector& Start, const FVector& End) const
+{
+	return QueryCache.LineTrace(OutHit, Start, End);
+}
+
+bool UPlayerMovementComponent::ClimbingSweep(FHitResult& OutHit, const FVector& Start, const FVector& End, const FQuat& Rotation, const FCollisionShape& Shape) const
+{
+	return QueryCache.Sweep(OutHit, Start, End, Rotation, Shape);
+}
+
+bool UPlayerMovementComponent::ShouldDrawDebug() const
+{
+#if UE_BUILD_SHIPPING || UE_SERVER
+	return false;
+#else
+	//the wall probe can run on a worker thread, debug drawing belongs to the game thread
+	return PlayerMovementCVars::DrawClimbingDebug != 0 && !IsNetMode(NM_DedicatedServer) && IsInGameThread();
+#endif
+}
+
+#if !UE_BUILD_SHIPPING
+void UPlayerMovementComponent::VerifyNoScratchReallocation()
+{
+	//the first climbing tick sizes the hit storage, after that a climbing tick should never touch the heap for it
+	if (!IsClimbing())
+	{
+		SteadyStateWallHitsSize = 0;
+		return;
+	}
+
+	const SIZE_T WallHitsSize = CurrentWallHits.GetAllocatedSize();
+	if (SteadyStateWallHitsSize == 0)
+	{
+		SteadyStateWallHitsSize = WallHitsSize;
+		return;
+	}
+
+	ensureMsgf(WallHitsSize == SteadyStateWallHitsSize, TEXT("Climbing tick reallocated its wall hit storage (%llu -> %llu bytes)"), (uint64)SteadyStateWallHitsSize, (uint64)WallHitsSize);
+	SteadyStateWallHitsSize = WallHitsSize;
 }
+#endif
 
 void UPlayerMovementComponent::OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity)
 {
@@ -64,7 +470,7 @@ void UPlayerMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovem
 	{
 		bOrientRotationToMovement = false;
 		UCapsuleComponent* Capsule = CharacterOwner->GetCapsuleComponent();
-		Capsule->SetCapsuleHalfHeight(Capsule->GetUnscaledCapsuleHalfHeight() - ClimbingCollisionShrinkAmount);
+		Capsule->SetCapsuleHalfHeight(Capsule->GetUnscaledCapsuleHalfHeight() - GetClimbingProfile().ClimbingCollisionShrinkAmount);
 
 		StopMovementImmediately();
 	}
@@ -72,18 +478,37 @@ void UPlayerMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovem
 	const bool bWasClimbing = PreviousMovementMode == MOVE_Custom && PreviousCustomMode == CMOVE_Climbing;
 	if (bWasClimbing)
 	{
+		bHasBaseRelativeSurface = false;
+		SurfaceCacheBase.Reset();
+		LastClimbedWall.Reset();
+		SurfaceWalker.Detach();
+		RejectedSurfaceWalkComponent.Reset();
+		DetachedSurfaceWalkComponent.Reset();
+		ReleaseAsyncClimbingSlot();
+
 		bOrientRotationToMovement = true;
 
 		const FRotator StandRotation = FRotator(0, UpdatedComponent->GetComponentRotation().Yaw, 0);
 		UpdatedComponent->SetRelativeRotation(StandRotation);
 
 		UCapsuleComponent* Capsule = CharacterOwner->GetCapsuleComponent();
-		Capsule->SetCapsuleHalfHeight(Capsule->GetUnscaledCapsuleHalfHeight() + ClimbingCollisionShrinkAmount);
+		Capsule->SetCapsuleHalfHeight(Capsule->GetUnscaledCapsuleHalfHeight() + GetClimbingProfile().ClimbingCollisionShrinkAmount);
 
 		StopMovementImmediately();
 	}
 
+	if (IsClimbing() != bWasClimbing && CharacterOwner->HasAuthority())
+	{
+		UIslandReplicationGraph::SetClimbingReplication(CharacterOwner, IsClimbing());
+	}
+
 	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	//after Super so listeners see the finished mode change
+	if (IsClimbing() != bWasClimbing)
+	{
+		OnClimbingStateChanged.Broadcast(IsClimbing());
+	}
 }
 
 void UPlayerMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
@@ -98,12 +523,27 @@ void UPlayerMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
 
 float UPlayerMovementComponent::GetMaxSpeed() const
 {
-	return IsClimbing() ? MaxClimbingSpeed : Super::GetMaxSpeed();
+	return IsClimbing() ? GetClimbingProfile().MaxClimbingSpeed : Super::GetMaxSpeed();
 }
 
 float UPlayerMovementComponent::GetMaxAcceleration() const
 {
-	return IsClimbing() ? MaxClimbingAcceleration : Super::GetMaxAcceleration();
+	return IsClimbing() ? GetClimbingProfile().MaxClimbingAcceleration : Super::GetMaxAcceleration();
+}
+
+void UPlayerMovementComponent::SetClimbingProfile(UClimbingProfile* NewProfile)
+{
+	const float OldShrinkAmount = GetClimbingProfile().ClimbingCollisionShrinkAmount;
+	ClimbingProfile = NewProfile;
+	//the new profile may not walk meshes, the next probe re-attaches if it does
+	SurfaceWalker.Detach();
+
+	//the capsule was shrunk by the old profile, re-shrink it so leaving the climb restores the right height
+	if (IsClimbing())
+	{
+		UCapsuleComponent* Capsule = CharacterOwner->GetCapsuleComponent();
+		Capsule->SetCapsuleHalfHeight(Capsule->GetUnscaledCapsuleHalfHeight() + OldShrinkAmount - GetClimbingProfile().ClimbingCollisionShrinkAmount);
+	}
 }
 
 void UPlayerMovementComponent::TryClimbing()
@@ -111,11 +551,92 @@ void UPlayerMovementComponent::TryClimbing()
 	bWantsToClimb = CanStartClimbing();
 }
 
+void UPlayerMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	const bool bRequestedClimb = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+	const bool bRequestedClimbDash = (Flags & FSavedMove_Character::FLAG_Custom_1) != 0;
+
+	//replayed moves on the owning client were already validated when they were made
+	if (CharacterOwner->GetLocalRole() != ROLE_Authority)
+	{
+		bWantsToClimb = bRequestedClimb;
+		bWantsToClimbDash = bRequestedClimbDash;
+		return;
+	}
+
+	//the server runs its own checks when a client starts a climb or dash rather than trusting the flag
+	if (bRequestedClimb && !bWantsToClimb)
+	{
+		SweepAndStoreWallHits();
+		bWantsToClimb = CanStartClimbing();
+	}
+	else if (!bRequestedClimb)
+	{
+		bWantsToClimb = false;
+	}
+
+	if (bRequestedClimbDash && !bWantsToClimbDash)
+	{
+		TryClimbDashing();
+	}
+}
+
+FNetworkPredictionData_Client* UPlayerMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UPlayerMovementComponent* MutableThis = const_cast<UPlayerMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_PlayerMovement(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void UPlayerMovementComponent::SendClientAdjustment()
+{
+	//a pending adjustment that isn't a good move ack is a correction
+	const FNetworkPredictionData_Server_Character* ServerData = HasPredictionData_Server() ? GetPredictionData_Server_Character() : nullptr;
+	if (ServerData && ServerData->PendingAdjustment.TimeStamp > 0.f && !ServerData->PendingAdjustment.bAckGoodMove)
+	{
+		NumClientCorrections++;
+	}
+
+	Super::SendClientAdjustment();
+}
+
 void UPlayerMovementComponent::CancelClimbing()
 {
 	bWantsToClimb = false;
 }
 
+void UPlayerMovementComponent::ResetClimbingState()
+{
+	bWantsToClimb = false;
+	StopClimbDashing();
+	//leaving the climb restores the capsule and releases the walker and async slot
+	if (IsClimbing())
+	{
+		SetMovementMode(EMovementMode::MOVE_Falling);
+	}
+	CurrentWallHits.Reset();
+	QueryCache.Invalidate();
+
+	if (bCanGrapple)
+	{
+		bCanGrapple = false;
+		ActorToGrapple = nullptr;
+		OnGrappleTargetChanged.Broadcast(false, LastValidGrapplePoint, nullptr);
+	}
+
+	if (IsValid(CurrentAnchor))
+	{
+		CurrentAnchor->Destroy();
+	}
+	CurrentAnchor = nullptr;
+}
+
 bool UPlayerMovementComponent::IsClimbing() const
 {
 	return MovementMode == EMovementMode::MOVE_Custom && CustomMovementMode == ECustomMovementMode::CMOVE_Climbing;
@@ -131,7 +652,7 @@ void UPlayerMovementComponent::TryClimbDashing()
 	if (!IsClimbing())
 		return;
 
-	if (!(ClimbDashCurve && !bWantsToClimbDash))
+	if (!(GetClimbingProfile().ClimbDashCurve && !bWantsToClimbDash))
 	{
 		return;
 	}
@@ -140,36 +661,163 @@ void UPlayerMovementComponent::TryClimbDashing()
 	bIsClimbDashing = true;
 	CurrentClimbDashTime = 0;
 	StoreClimbDashDirection();
+	AsyncDashSequence++;
+	OnClimbDashStateChanged.Broadcast(true);
 }
 
 void UPlayerMovementComponent::SweepAndStoreWallHits()
 {
-	const FCollisionShape CollisionShape = FCollisionShape::MakeCapsule(CollisionCapsuleRadius, CollisionCapsuleHalfHeight);
+	RunClimbingProbes(EClimbingProbes::Wall);
+}
 
-	//gets the current forward vector of the current component which is called UpdatedComponent for some reason
-	const FVector StartOffset = (UpdatedComponent->GetForwardVector() * 30);
+void UPlayerMovementComponent::RunClimbingProbes(EClimbingProbes Probes)
+{
+	TArray<FVector, TInlineAllocator<NumSurfaceProbes>> CornerProbeStarts;
+	for (const USceneComponent* RaycastLocation : RaycastLocations)
+	{
+		CornerProbeStarts.Add(RaycastLocation->GetComponentLocation());
+	}
 
-	//Avoid using the same Start/End location for a Sweep, as it doesn't trigger hits on landscapes
-	const FVector SweepStartPosition = UpdatedComponent->GetComponentLocation() + StartOffset;
-	const FVector SweepEndPosition = SweepStartPosition + UpdatedComponent->GetForwardVector() * 50;
+	FClimbingProbeResult Result;
+	RunClimbingProbes(QueryCache, GetClimbingProfile(), UpdatedComponent->GetComponentLocation(), UpdatedComponent->GetComponentQuat(), CornerProbeStarts,
+		Probes, CurrentWallHits, Result, ShouldDrawDebug() ? GetWorld() : nullptr);
 
-	//do a sweep and store them
-	TArray<FHitResult> Hits;
-	const bool HitWall = GetWorld()->SweepMultiByChannel(Hits, SweepStartPosition, SweepEndPosition, CharacterOwner->GetActorQuat(), ECC_WorldStatic, CollisionShape, ClimbingQueryParameters);
-	if (HitWall)
+	if (Probes != EClimbingProbes::Wall)
 	{
-		CurrentWallHits = Hits;
-		//draws debug hits
-		UKismetSystemLibrary::DrawDebugCapsule(GetWorld(), SweepStartPosition, CollisionCapsuleHalfHeight, CollisionCapsuleRadius, CharacterOwner->GetActorQuat().Rotator());
-		for (FHitResult& Hit : CurrentWallHits)
+		CurrentClimbingPosition = Result.Position;
+		CurrentClimbingNormal = Result.Normal;
+		NumSurfaceProbeContacts = Result.NumCornerContacts;
+	}
+}
+
+void UPlayerMovementComponent::GetCornerProbeComponents(const ACharacter& Character, TArray<USceneComponent*>& OutComponents)
+{
+	//the corner points are added to the capsule on the blueprint after everything the native class attaches
+	OutComponents = Character.GetCapsuleComponent()->GetAttachChildren();
+	if (OutComponents.Num() > NumSurfaceProbes)
+	{
+		OutComponents.RemoveAt(0, OutComponents.Num() - NumSurfaceProbes);
+	}
+}
+
+void UPlayerMovementComponent::RunClimbingProbes(FEnvironmentQueryCache& Queries, const UClimbingProfile& Profile, const FVector& Location, const FQuat& Rotation, TConstArrayView<FVector> CornerProbeStarts,
+	EClimbingProbes Probes, TArray<FHitResult>& InOutWallHits, FClimbingProbeResult& OutResult, const UObject* DebugContext)
+{
+	const FVector Forward = Rotation.GetForwardVector();
+
+	if (Probes != EClimbingProbes::Surface)
+	{
+		const FCollisionShape CollisionShape = FCollisionShape::MakeCapsule(Profile.CollisionCapsuleRadius, Profile.CollisionCapsuleHalfHeight);
+
+		//Avoid using the same Start/End location for a Sweep, as it doesn't trigger hits on landscapes
+		const FVector SweepStartPosition = Location + Forward * WallSweepStartOffset;
+		const FVector SweepEndPosition = SweepStartPosition + Forward * WallSweepLength;
+
+		//sweep straight into the stored hits so the array keeps its capacity between ticks
+		//a climb request on the server sweeps from the same spot the tick does, so the second one comes from the cache
+		const bool HitWall = Queries.SweepMulti(InOutWallHits, SweepStartPosition, SweepEndPosition, Rotation, CollisionShape);
+		if (HitWall)
+		{
+			OutResult.NumSweptWallHits = InOutWallHits.Num();
+			if (InOutWallHits.Num() > MaxWallHits)
+			{
+				//multi sweeps report the blocking hit last, keep it over the overlaps we drop
+				if (InOutWallHits.Last().bBlockingHit)
+				{
+					InOutWallHits[MaxWallHits - 1] = InOutWallHits.Last();
+				}
+				InOutWallHits.SetNum(MaxWallHits, EAllowShrinking::No);
+			}
+
+			//draws debug hits
+			if (DebugContext)
+			{
+				UKismetSystemLibrary::DrawDebugCapsule(DebugContext, SweepStartPosition, Profile.CollisionCapsuleHalfHeight, Profile.CollisionCapsuleRadius, Rotation.Rotator());
+				for (const FHitResult& Hit : InOutWallHits)
+				{
+					UKismetSystemLibrary::DrawDebugSphere(DebugContext, Hit.ImpactPoint, 5.f, 12, FLinearColor::Blue, 0, 10.f);
+				}
+			}
+		}
+		else
 		{
-			UKismetSystemLibrary::DrawDebugSphere(GetWorld(), Hit.ImpactPoint, 5.f, 12, FLinearColor::Blue, 0, 10.f);
+			OutResult.NumSweptWallHits = 0;
+			InOutWallHits.Reset();
 		}
 	}
-	else
+
+	if (Probes == EClimbingProbes::Wall)
+		return;
+
+	OutResult.Position = FVector::ZeroVector;
+	OutResult.Normal = FVector::ZeroVector;
+	OutResult.NumCornerContacts = 0;
+	if (InOutWallHits.IsEmpty())
+		return;
+
+	//one assist sweep towards every wall hit, averaged in floats around the character since every assist hit is within reach of it
+	const FCollisionShape AssistSphere = FCollisionShape::MakeSphere(SurfaceAssistRadius);
+	const FClimbingLocalFrame CharacterFrame(Location);
+	FVector3f LocalClimbingPositionSum = FVector3f::ZeroVector;
+	FVector3f SurfaceNormal = FVector3f::ZeroVector;
+	for (const FHitResult& WallHit : InOutWallHits)
 	{
-		CurrentWallHits.Reset();
+		const FVector EndPosition = Location + (WallHit.ImpactPoint - Location).GetSafeNormal() * SurfaceAssistDistance;
+
+		FHitResult AssistHit;
+		Queries.Sweep(AssistHit, Location, EndPosition, FQuat::Identity, AssistSphere);
+		LocalClimbingPositionSum += CharacterFrame.ToLocal(AssistHit.ImpactPoint);
+		SurfaceNormal += FVector3f(AssistHit.Normal);
 	}
+	OutResult.Position = CharacterFrame.ToWorld(LocalClimbingPositionSum / InOutWallHits.Num());
+
+	//the corner probes all land within a metre or two of the climbing position, so the triangles are built in floats around it
+	const FClimbingLocalFrame Frame(OutResult.Position);
+	const FCollisionShape CornerSphere = FCollisionShape::MakeSphere(CornerProbeRadius);
+	TArray<FVector3f, TInlineAllocator<NumSurfaceProbes>> HitPoints;
+	for (const FVector& StartLocation : CornerProbeStarts)
+	{
+		FHitResult Hit;
+		const FVector EndLocation = StartLocation + Forward * CornerProbeLength;
+		if (Queries.Sweep(Hit, StartLocation, EndLocation, FQuat::Identity, CornerSphere))
+		{
+			HitPoints.Add(Frame.ToLocal(Hit.ImpactPoint));
+			if (DebugContext)
+			{
+				UKismetSystemLibrary::DrawDebugLine(DebugContext, StartLocation, EndLocation, FColor::White);
+				UKismetSystemLibrary::DrawDebugPoint(DebugContext, Hit.ImpactPoint, 10, FColor::Red);
+				UKismetSystemLibrary::DrawDebugSphere(DebugContext, Hit.ImpactPoint + Hit.ImpactNormal, 10);
+			}
+		}
+	}
+
+	OutResult.NumCornerContacts = HitPoints.Num();
+	if (HitPoints.Num() == NumSurfaceProbes)
+	{
+		const FVector3f& PointA = HitPoints[0];
+		const FVector3f& PointB = HitPoints[1];
+		const FVector3f& PointC = HitPoints[2];
+		const FVector3f& PointD = HitPoints[3];
+
+		//only triangles ABC and ABD go into the normal, ADC and BDC are drawn alongside them to show how flat the wall is
+		if (DebugContext)
+		{
+			auto DrawTriangleNormal = [DebugContext, &Frame](const FVector3f& First, const FVector3f& Second, const FVector3f& Third)
+			{
+				const FVector3f CenterPoint = (First + Second + Third) / 3;
+				const FVector3f TriangleNormal = ClimbingSolverMath::TriangleNormal(First, Second, Third);
+				UKismetSystemLibrary::DrawDebugLine(DebugContext, Frame.ToWorld(CenterPoint), Frame.ToWorld(CenterPoint + (TriangleNormal * 10)), FColor::Blue);
+			};
+			DrawTriangleNormal(PointA, PointB, PointC);
+			DrawTriangleNormal(PointA, PointB, PointD);
+			DrawTriangleNormal(PointA, PointD, PointC);
+			DrawTriangleNormal(PointB, PointD, PointC);
+		}
+
+		SurfaceNormal += ClimbingSolverMath::CornerProbeNormal(PointA, PointB, PointC, PointD, SurfaceNormal);
+	}
+
+	OutResult.Normal = FVector(SurfaceNormal.GetSafeNormal());
 }
 
 bool UPlayerMovementComponent::CanStartClimbing()
@@ -182,9 +830,10 @@ bool UPlayerMovementComponent::CanStartClimbing()
 		const float HorizontalDot = FVector::DotProduct(UpdatedComponent->GetForwardVector(), -WallNormal);//checks to see if the player is looking at wall
 		const float VerticalDot = FVector::DotProduct(Hit.Normal, WallNormal);//checks how steep the wall is to make the eye trace longer for steeper inclines
 
-		const float angle = FMath::RadiansToDegrees(FMath::Acos(HorizontalDot));//the angle from where the player is facing and the wall
+		//the angle from where the player is facing and the wall is within MinSurfaceNormalAngle
+		const bool bFacingWall = HorizontalDot >= GetClimbingProfile().CosMinSurfaceNormalAngle;
 
-		if (angle <= MinSurfaceNormalAngle && IsClimbableSurface(WallNormal) && IsFacingSurface(VerticalDot))
+		if (bFacingWall && IsClimbableSurface(WallNormal) && IsFacingSurface(VerticalDot))
 		{
 			LedgeTraceDistance = CharacterOwner->GetCapsuleComponent()->GetUnscaledCapsuleRadius() * 3.5f;
 			return true;
@@ -200,12 +849,12 @@ bool UPlayerMovementComponent::EyeHeightTrace(const float TraceDistance, FVector
 	FHitResult UpperEdgeHit;
 
 	const float BaseEyeHeight = GetCharacterOwner()->BaseEyeHeight;
-	const float EyeHeightOffset = IsClimbing() ? BaseEyeHeight - (ClimbingCollisionShrinkAmount/3.0f) : BaseEyeHeight;	
+	const float EyeHeightOffset = IsClimbing() ? BaseEyeHeight - GetClimbingProfile().ClimbingEyeHeightOffset : BaseEyeHeight;	
 
 	const FVector StartingPosition = UpdatedComponent->GetComponentLocation() + (UpdatedComponent->GetUpVector() * EyeHeightOffset);
 	const FVector EndPosition = StartingPosition + (UpdatedComponent->GetForwardVector() * TraceDistance);
 
-	bool bHitSomething = GetWorld()->LineTraceSingleByChannel(UpperEdgeHit, StartingPosition, EndPosition, ECC_WorldStatic, ClimbingQueryParameters);
+	bool bHitSomething = ClimbingLineTrace(UpperEdgeHit, StartingPosition, EndPosition);
 	//UKismetSystemLibrary::DrawDebugLine(GetWorld(), StartingPosition, EndPosition, FLinearColor::Yellow);
 
 	if (bHitSomething)
@@ -230,13 +879,11 @@ bool UPlayerMovementComponent::IsFacingSurface(const float Steepness) const
 
 bool UPlayerMovementComponent::IsClimbableSurface(const FVector WallNormal) const
 {
+	const UClimbingProfile& Profile = GetClimbingProfile();
 	float WallDotProduct = FVector::DotProduct(FVector::UpVector, WallNormal);
-	float WallAngle = FMath::RadiansToDegrees(FMath::Acos(WallDotProduct));
 
-	/*GEngine->AddOnScreenDebugMessage(-1, 30, FColor::Red, TEXT("------------------------------------------------------"));
-	GEngine->AddOnScreenDebugMessage(-1, 30, FColor::Red, FString::Printf(TEXT("Wall Angle: %f"), WallAngle));
-	GEngine->AddOnScreenDebugMessage(-1, 30, FColor::Red, FString::Printf(TEXT("Min Angle: %f\n Max Angle:%f"), MinClimbingAngle,MaxClimbingAngle));*/
-	bool bIsClimbableSurface = WallAngle > MinClimbingAngle && WallAngle < MaxClimbingAngle;
+	//same as MinClimbingAngle < angle < MaxClimbingAngle, compared in cosine space since acos is decreasing
+	bool bIsClimbableSurface = WallDotProduct < Profile.CosMinClimbingAngle && WallDotProduct > Profile.CosMaxClimbingAngle;
 	//GEngine->AddOnScreenDebugMessage(-1, 30, FColor::Red, TEXT("IsClimbable?" + bIsClimbableSurface ? "true" : "false"));
 
 	return bIsClimbableSurface;
@@ -244,10 +891,34 @@ bool UPlayerMovementComponent::IsClimbableSurface(const FVector WallNormal) cons
 
 void UPlayerMovementComponent::PhysClimbing(float deltaTime, int32 Iterations)
 {
+	LLM_SCOPE_BYTAG(ClimbingMovement);
+
 	if (deltaTime < MIN_TICK_TIME)
 		return;
 
-	ComputeSurfaceInfo();
+	//probe the wall once per frame, the substeps below reuse the result
+	//on a moving base the last probe is kept in the base's space and reused until we move relative to it,
+	//and on a walkable mesh the surface is followed along its triangles instead of probed
+	const bool bWasSurfaceWalking = SurfaceWalker.IsAttached();
+	//only the first update of a frame can use the probe stage's surface, later moves on a server have moved on from it
+	const bool bSurfaceProbed = bSurfaceProbedThisFrame;
+	bSurfaceProbedThisFrame = false;
+	if (!TryWalkClimbingSurface() && !TryReuseBaseRelativeSurface())
+	{
+		//the base has already moved us this frame, the hits from last tick are where the wall used to be
+		//and the tick doesn't sweep at all while walking, so a walk that just gave up has no hits of its own
+		if (CharacterOwner->GetMovementBase() || bWasSurfaceWalking)
+		{
+			RunClimbingProbes(EClimbingProbes::WallAndSurface);
+		}
+		else if (!bSurfaceProbed)
+		{
+			ComputeSurfaceInfo();
+		}
+		UpdateClimbingAnchor();
+		UpdateClimbingBase();
+		TryAttachSurfaceWalker();
+	}
 
 	if (ShouldStopClimbing() || ClimbDownToFloor())
 	{
@@ -255,128 +926,294 @@ void UPlayerMovementComponent::PhysClimbing(float deltaTime, int32 Iterations)
 		return;
 	}
 
+	if (UClimbingAsyncSubsystem* AsyncClimbing = GetAsyncClimbing())
+	{
+		PhysClimbingAsync(deltaTime, Iterations, *AsyncClimbing);
+		return;
+	}
+	//the physics thread has to start over from wherever the game thread leaves us
+	ReleaseAsyncClimbingSlot();
+
+	float RemainingTime = deltaTime;
+	while (RemainingTime >= MIN_TICK_TIME && Iterations < GetClimbingProfile().MaxClimbingSimulationIterations && CharacterOwner)
+	{
+		Iterations++;
+		const float TimeTick = GetClimbingSimulationTimeStep(RemainingTime, Iterations);
+		RemainingTime -= TimeTick;
+
+		if (!ClimbingSubstep(TimeTick, RemainingTime, Iterations))
+		{
+			return;
+		}
+	}
+}
+
+UClimbingAsyncSubsystem* UPlayerMovementComponent::GetAsyncClimbing() const
+{
+	//the async results don't go through saved moves, so networked games and root motion stay on the game thread
+	if (!GetClimbingProfile().bSimulateOnAsyncPhysicsTick || GetNetMode() != NM_Standalone || HasAnimRootMotion() || CurrentRootMotion.HasActiveRootMotionSources())
+		return nullptr;
+
+	UClimbingAsyncSubsystem* AsyncClimbing = UWorld::GetSubsystem<UClimbingAsyncSubsystem>(GetWorld());
+	return AsyncClimbing && AsyncClimbing->IsAvailable() ? AsyncClimbing : nullptr;
+}
+
+void UPlayerMovementComponent::ReleaseAsyncClimbingSlot()
+{
+	if (AsyncClimbingSlot == INDEX_NONE)
+		return;
+
+	if (UClimbingAsyncSubsystem* AsyncClimbing = UWorld::GetSubsystem<UClimbingAsyncSubsystem>(GetWorld()))
+	{
+		AsyncClimbing->UnregisterClimber(AsyncClimbingSlot);
+	}
+	AsyncClimbingSlot = INDEX_NONE;
+}
+
+void UPlayerMovementComponent::PhysClimbingAsync(float deltaTime, int32 Iterations, UClimbingAsyncSubsystem& AsyncClimbing)
+{
+	if (AsyncClimbingSlot == INDEX_NONE)
+	{
+		AsyncClimbingSlot = AsyncClimbing.RegisterClimber();
+		AsyncResyncSequence = AsyncClimbing.NewResyncSequence();
+	}
+
+	//the wall probes above stay on the game thread, the physics thread only integrates against the surface they found
+	const UClimbingProfile& Profile = GetClimbingProfile();
+	FClimbingAsyncIntent Intent;
+	Intent.Slot = AsyncClimbingSlot;
+	Intent.ResyncSequence = AsyncResyncSequence;
+	Intent.Location = UpdatedComponent->GetComponentLocation();
+	Intent.Rotation = UpdatedComponent->GetComponentQuat();
+	Intent.Velocity = Velocity;
+	Intent.Acceleration = Acceleration;
+	Intent.SurfaceNormal = CurrentClimbingNormal;
+	Intent.SurfacePosition = CurrentClimbingPosition;
+	Intent.DashSequence = AsyncDashSequence;
+	Intent.DashDirection = ClimbDashDirection;
+	Intent.MaxSpeed = Profile.MaxClimbingSpeed;
+	Intent.MaxAcceleration = Profile.MaxClimbingAcceleration;
+	Intent.Deceleration = Profile.ClimbingDeceleration;
+	Intent.InvMaxSpeed = Profile.InvMaxClimbingSpeed;
+	Intent.SnapSpeed = Profile.ClimbingSnapSpeed;
+	Intent.RotationSpeed = Profile.ClimbingRotationSpeed;
+	Intent.DistanceFromSurface = Profile.DistanceFromSurface;
+	Intent.DashDuration = Profile.ClimbDashDuration;
+	Intent.DashSpeedSamples = Profile.ClimbDashSpeedSamples;
+	AsyncClimbing.QueueIntent(Intent);
+
+	//keeps IsClimbDashing in step with the dash the physics thread is running
 	UpdateClimbDashState(deltaTime);
-	ComputeClimbingVelocity(deltaTime);
 
-	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+	FClimbingAsyncResult Result;
+	if (!AsyncClimbing.GetInterpolatedResult(AsyncClimbingSlot, Result))
+		return;
 
-	MoveAlongClimbingSurface(deltaTime);
+	//the physics thread doesn't collide, so the interpolated result is still applied with a sweep
+	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+	const FVector Delta = Result.Location - OldLocation;
+	FHitResult Hit(1.f);
+	SafeMoveUpdatedComponent(Delta, Result.Rotation, true, Hit);
+	const bool bBlocked = Hit.Time < 1.f;
+	if (bBlocked)
+	{
+		HandleImpact(Hit, deltaTime, Delta);
+		SlideAlongSurface(Delta, 1.f - Hit.Time, Hit.Normal, Hit, true);
+		//we ended up somewhere the physics thread didn't simulate
+		AsyncResyncSequence = AsyncClimbing.NewResyncSequence();
+	}
 
 	if (TryClimbUpLedge(deltaTime, Iterations))
-	{
 		return;
+
+	if (!HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity())
+	{
+		Velocity = bBlocked ? (UpdatedComponent->GetComponentLocation() - OldLocation) / deltaTime : Result.Velocity;
+	}
+}
+
+float UPlayerMovementComponent::GetClimbingSimulationTimeStep(float RemainingTime, int32 Iterations) const
+{
+	//same splitting as UCharacterMovementComponent::GetSimulationTimeStep, but with the climbing limits
+	const UClimbingProfile& Profile = GetClimbingProfile();
+	if (RemainingTime > Profile.MaxClimbingSimulationTimeStep && Iterations < Profile.MaxClimbingSimulationIterations)
+	{
+		//split evenly instead of leaving a tiny last step
+		RemainingTime = FMath::Min(Profile.MaxClimbingSimulationTimeStep, RemainingTime * 0.5f);
+	}
+
+	return FMath::Max(MIN_TICK_TIME, RemainingTime);
+}
+
+bool UPlayerMovementComponent::ClimbingSubstep(float timeTick, float RemainingTime, int32 Iterations)
+{
+	UpdateClimbDashState(timeTick);
+	ComputeClimbingVelocity(timeTick);
+
+	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+
+	MoveAlongClimbingSurface(timeTick);
+
+	if (TryClimbUpLedge(RemainingTime, Iterations))
+	{
+		return false;
 	}
-	
 
 	if (!HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity())
 	{
-		Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / deltaTime;
+		Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / timeTick;
 	}
 
-	SnapToClimbingSurface(deltaTime);
+	SnapToClimbingSurface(timeTick);
+	return true;
 }
 
 void UPlayerMovementComponent::ComputeSurfaceInfo()
 {
-	CurrentClimbingNormal = FVector::ZeroVector;
-	CurrentClimbingPosition = FVector::ZeroVector;
+	RunClimbingProbes(EClimbingProbes::Surface);
+}
 
+void UPlayerMovementComponent::UpdateClimbingAnchor()
+{
+	//moves an actor, so this stays on the game thread while the probes above may run in the probe stage
 	if (CurrentWallHits.IsEmpty())
 		return;
 
-	const FVector StartPosition = UpdatedComponent->GetComponentLocation();
-	const FCollisionShape CollisionSphere = FCollisionShape::MakeSphere(10);
-	TArray<FVector> Normals;
-	for (const FHitResult& WallHit : CurrentWallHits)
+	if (IsValid(CurrentAnchor))
+	{
+		CurrentAnchor->UpdateAnchorLocation(CurrentClimbingPosition);
+	}
+	else if (ShouldDrawDebug())
 	{
-		const FVector EndPosition = StartPosition + (WallHit.ImpactPoint - StartPosition).GetSafeNormal() * 120;
+		GEngine->AddOnScreenDebugMessage(-1, 0, FColor::Red, TEXT("CurrentAnchor not set while climbing, is this intended?"));
+	}
+}
 
-		FHitResult AssistHit;
-		GetWorld()->SweepSingleByChannel(AssistHit, StartPosition, EndPosition, FQuat::Identity, ECC_WorldStatic, CollisionSphere, ClimbingQueryParameters);
-		CurrentClimbingPosition += AssistHit.ImpactPoint;
-		Normals.Add(AssistHit.Normal);
+bool UPlayerMovementComponent::TryReuseBaseRelativeSurface()
+{
+	const UPrimitiveComponent* Base = CharacterOwner->GetMovementBase();
+	if (!bHasBaseRelativeSurface || !Base || Base != SurfaceCacheBase.Get() || bWantsToClimbDash)
+		return false;
+
+	const FTransform BaseTransform = Base->GetComponentTransform();
+	const FVector LocalLocation = BaseTransform.InverseTransformPosition(UpdatedComponent->GetComponentLocation());
+	const FVector LocalForward = BaseTransform.InverseTransformVectorNoScale(UpdatedComponent->GetForwardVector());
+	if (FVector::DistSquared(LocalLocation, LocalProbeLocation) > FMath::Square(GetClimbingProfile().ClimbingReprobeDistance)
+		|| FVector::DotProduct(LocalForward, LocalProbeForward) < 1.f - KINDA_SMALL_NUMBER)
+		return false;
+
+	//the anchor follows the base by itself, so only the surface has to be brought into world space
+	CurrentClimbingNormal = BaseTransform.TransformVectorNoScale(LocalClimbingNormal);
+	CurrentClimbingPosition = BaseTransform.TransformPosition(LocalClimbingPosition);
+	return true;
+}
+
+bool UPlayerMovementComponent::TryWalkClimbingSurface()
+{
+	if (!SurfaceWalker.IsAttached())
+		return false;
+
+	//the contact point follows however far we moved along the wall since the last frame
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	if (!SurfaceWalker.Walk(Location - LastSurfaceWalkLocation, GetClimbingProfile().CosMaxMeshWalkCreaseAngle))
+	{
+		//otherwise the next probe attaches right back at the crease or edge that just stopped us, every frame
+		DetachedSurfaceWalkComponent = SurfaceWalker.GetComponent();
+		SurfaceWalkDetachLocation = Location;
+		SurfaceWalker.Detach();
+		return false;
 	}
-	CurrentClimbingPosition /= CurrentWallHits.Num();
-	if (CurrentAnchor)
+
+	LastSurfaceWalkLocation = Location;
+	CurrentClimbingNormal = SurfaceWalker.GetWorldNormal();
+	CurrentClimbingPosition = SurfaceWalker.GetWorldPoint();
+	NumSurfaceProbeContacts = NumSurfaceProbes;
+	if (IsValid(CurrentAnchor))
 	{
 		CurrentAnchor->UpdateAnchorLocation(CurrentClimbingPosition);
 	}
-	else
+	return true;
+}
+
+void UPlayerMovementComponent::TryAttachSurfaceWalker()
+{
+	//moving bases already have their own cache, and a wall made of several meshes has no single mesh to walk
+	if (!GetClimbingProfile().bUseMeshWalking || CurrentWallHits.IsEmpty() || CurrentClimbingNormal.IsZero() || CharacterOwner->GetMovementBase())
+		return;
+
+	const UPrimitiveComponent* Wall = CurrentWallHits[0].GetComponent();
+	if (!Wall || Wall == RejectedSurfaceWalkComponent.Get())
+		return;
+
+	for (const FHitResult& WallHit : CurrentWallHits)
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 0, FColor::Red, TEXT("CurrentAnchor not set while climbing, is this intended?"));
+		if (WallHit.GetComponent() != Wall)
+			return;
+	}
+
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	if (Wall == DetachedSurfaceWalkComponent.Get() && FVector::DistSquared(Location, SurfaceWalkDetachLocation) < FMath::Square(SurfaceWalkReattachDistance))
+		return;
+
+	if (!SurfaceWalker.Attach(Wall, CurrentClimbingPosition, Location, SurfaceWalkAttachDistance))
+	{
+		RejectedSurfaceWalkComponent = Wall;
+		return;
 	}
-	GetAverageSurfaceNormals(Normals);
+	LastSurfaceWalkLocation = Location;
 }
 
-void UPlayerMovementComponent::GetAverageSurfaceNormals(const TArray<FVector>& Normals)
+void UPlayerMovementComponent::UpdateClimbingBase()
 {
-	
-	for (int count = 0; count < Normals.Num(); count++)
+	//climb relative to whatever moving thing we are holding on to, the engine then carries us along with it
+	//movable but idle geometry is climbed in world space, basing on it would only re-probe every frame for nothing
+	//a base we already hold is kept while it pauses so we don't flip in and out of base space
+	//timelines and sequences move platforms by setting their transform and leave the velocity at zero, so a wall that moved since the last update counts too
+	const UPrimitiveComponent* CurrentBase = CharacterOwner->GetMovementBase();
+	const UPrimitiveComponent* LastWall = LastClimbedWall.Get();
+	UPrimitiveComponent* NewBase = nullptr;
+	UPrimitiveComponent* MovableWall = nullptr;
+	for (const FHitResult& WallHit : CurrentWallHits)
 	{
-		CurrentClimbingNormal += Normals[count];
+		UPrimitiveComponent* HitComponent = WallHit.GetComponent();
+		if (!HitComponent || !MovementBaseUtility::UseRelativeLocation(HitComponent))
+			continue;
+
+		MovableWall = MovableWall ? MovableWall : HitComponent;
+		const bool bMovedSinceLastUpdate = HitComponent == LastWall && !HitComponent->GetComponentTransform().Equals(LastClimbedWallTransform);
+		if (HitComponent == CurrentBase || bMovedSinceLastUpdate || HitComponent->IsSimulatingPhysics() || !HitComponent->GetComponentVelocity().IsNearlyZero())
+		{
+			NewBase = HitComponent;
+			break;
+		}
 	}
 
-	//get the additional 4 triangles from the 4 sphere points in Raycast locations
-	TArray<FVector> HitPoints;
-	for (int count = 0; count < RaycastLocations.Num(); count++)
+	//the wall the next update compares against, the base itself once we hold one
+	LastClimbedWall = NewBase ? NewBase : MovableWall;
+	if (LastClimbedWall.IsValid())
 	{
-		FHitResult Hit;
-		const FVector StartLocation = RaycastLocations[count]->GetComponentLocation();
-		const FVector EndLocation = StartLocation + UpdatedComponent->GetForwardVector() * 100;
-		const FCollisionShape CollisionSphere = FCollisionShape::MakeSphere(10);
-		if (GetWorld()->SweepSingleByChannel(Hit,StartLocation,EndLocation, FQuat::Identity,ECC_WorldStatic,CollisionSphere,ClimbingQueryParameters))
+		LastClimbedWallTransform = LastClimbedWall->GetComponentTransform();
+	}
+
+	if (NewBase != CharacterOwner->GetMovementBase())
+	{
+		SetBase(NewBase);
+		if (NewBase && IsValid(CurrentAnchor))
 		{
-			HitPoints.Add(Hit.ImpactPoint);
-			UKismetSystemLibrary::DrawDebugLine(GetWorld(), StartLocation, EndLocation, FColor::White);
-			UKismetSystemLibrary::DrawDebugPoint(GetWorld(), Hit.ImpactPoint,10,FColor::Red);
-			UKismetSystemLibrary::DrawDebugSphere(GetWorld(), Hit.ImpactPoint + Hit.ImpactNormal, 10);
+			CurrentAnchor->FollowBase(NewBase);
 		}
 	}
 
-	if (HitPoints.Num() == 4)
-	{
-		FVector PointA = HitPoints[0];
-		FVector PointB = HitPoints[1];
-		FVector PointC = HitPoints[2];
-		FVector PointD = HitPoints[3];
-
-		//Triangle ABC
-		FVector FirstTriangleNormal;
-		FVector FirstSideA = PointB - PointA;
-		FVector FirstSideB = PointC - PointA;
-		FirstTriangleNormal = FVector::CrossProduct(FirstSideA, FirstSideB);
-		FVector CenterPoint = (PointA + PointB + PointC) / 3;
-		UKismetSystemLibrary::DrawDebugLine(GetWorld(), CenterPoint, CenterPoint + (FirstTriangleNormal * 10), FColor::Blue);
-
-		//Triangle ABD
-		FVector SecondTriangleNormal;
-		FVector SecondSideA = PointB - PointA;
-		FVector SecondSideB = PointD - PointA;
-		SecondTriangleNormal = FVector::CrossProduct(FirstSideA, FirstSideB);
-		CenterPoint = (PointA + PointB + PointD) / 3;
-		UKismetSystemLibrary::DrawDebugLine(GetWorld(), CenterPoint, CenterPoint + (SecondTriangleNormal * 10), FColor::Blue);
-
-		//Triangle ADC
-		FVector ThirdTriangleNormal;
-		FVector ThirdSideA = PointD - PointA;
-		FVector ThirdSideB = PointC - PointA;
-		ThirdTriangleNormal = FVector::CrossProduct(ThirdSideA, ThirdSideB);
-		CenterPoint = (PointA + PointD + PointC) / 3;
-		UKismetSystemLibrary::DrawDebugLine(GetWorld(), CenterPoint, CenterPoint + (ThirdTriangleNormal * 10), FColor::Blue);
-
-		//Triangle BDC
-		FVector FourthTriangleNormal;
-		FVector FourthSideA = PointD - PointB;
-		FVector FourthSideB = PointC - PointB;
-		FourthTriangleNormal = FVector::CrossProduct(FirstSideA, FirstSideB);
-		CenterPoint = (PointB + PointD + PointC) / 3;
-		UKismetSystemLibrary::DrawDebugLine(GetWorld(), CenterPoint, CenterPoint + (FourthTriangleNormal * 10), FColor::Blue);
-
-		CurrentClimbingNormal += FirstTriangleNormal + SecondTriangleNormal;
-	}
-
-	CurrentClimbingNormal = CurrentClimbingNormal.GetSafeNormal();
-	
+	bHasBaseRelativeSurface = NewBase != nullptr && !CurrentClimbingNormal.IsZero();
+	SurfaceCacheBase = NewBase;
+	if (!bHasBaseRelativeSurface)
+		return;
+
+	const FTransform BaseTransform = NewBase->GetComponentTransform();
+	LocalClimbingNormal = BaseTransform.InverseTransformVectorNoScale(CurrentClimbingNormal);
+	LocalClimbingPosition = BaseTransform.InverseTransformPosition(CurrentClimbingPosition);
+	LocalProbeLocation = BaseTransform.InverseTransformPosition(UpdatedComponent->GetComponentLocation());
+	LocalProbeForward = BaseTransform.InverseTransformVectorNoScale(UpdatedComponent->GetForwardVector());
 }
 
 void UPlayerMovementComponent::ComputeClimbingVelocity(float deltaTime)
@@ -389,16 +1226,16 @@ void UPlayerMovementComponent::ComputeClimbingVelocity(float deltaTime)
 		{
 			AlignClimbDashDirection();
 
-			const float CurrentCurveSpeed = ClimbDashCurve->GetFloatValue(CurrentClimbDashTime);
-			UE_LOG(LogTemp, Log, TEXT("CurrentCurveSpeed: %f"),CurrentCurveSpeed)
+			const float CurrentCurveSpeed = GetClimbingProfile().ClimbDashCurve->GetFloatValue(CurrentClimbDashTime);
+			UE_LOG(LogTemp, Verbose, TEXT("CurrentCurveSpeed: %f"),CurrentCurveSpeed)
 			Velocity = ClimbDashDirection * CurrentCurveSpeed;
-			UE_LOG(LogTemp, Log, TEXT("Velocity: %s"), *(Velocity.ToString()));
+			UE_LOG(LogTemp, Verbose, TEXT("Velocity: %s"), *(Velocity.ToString()));
 		}
 		else
 		{
 			constexpr float Friction = 0.f;
 			constexpr bool bFluid = false;
-			CalcVelocity(deltaTime, Friction, bFluid, ClimbingDeceleration);
+			CalcVelocity(deltaTime, Friction, bFluid, GetClimbingProfile().ClimbingDeceleration);
 		}
 	}
 
@@ -435,26 +1272,32 @@ void UPlayerMovementComponent::MoveAlongClimbingSurface(float deltaTime)
 
 void UPlayerMovementComponent::SnapToClimbingSurface(float deltaTime) const
 {
-	const FVector Forward = UpdatedComponent->GetForwardVector();
-	const FVector Location = UpdatedComponent->GetComponentLocation();
+	const FVector3f Forward = FVector3f(UpdatedComponent->GetForwardVector());
+	const FClimbingLocalFrame Frame(CurrentClimbingPosition);
+	const FVector3f Location = Frame.ToLocal(UpdatedComponent->GetComponentLocation());
 	const FQuat Rotation = UpdatedComponent->GetComponentQuat();
 
-	const FVector ForwardDifference = (CurrentClimbingPosition - Location).ProjectOnTo(Forward);
-	const FVector Offset = -CurrentClimbingNormal * (ForwardDifference.Length() - DistanceFromSurface);
+	const UClimbingProfile& Profile = GetClimbingProfile();
+	//the climbing position is the frame's origin
+	const FVector3f Offset = ClimbingSolverMath::SnapOffset(-Location, Forward, FVector3f(CurrentClimbingNormal), Profile.DistanceFromSurface);
 
 	constexpr bool bSweep = true;
-	const float SnapSpeed = ClimbingSnapSpeed * FMath::Max(1, Velocity.Length() / MaxClimbingSpeed);
-	UpdatedComponent->MoveComponent(Offset * SnapSpeed * deltaTime, Rotation, bSweep);
+	const float SnapSpeed = Profile.ClimbingSnapSpeed * ClimbingSolverMath::SpeedScale((float)Velocity.Length(), Profile.InvMaxClimbingSpeed);
+	//exponential rather than linear so the snap converges the same way whatever the step size
+	const float SnapAlpha = ClimbingSolverMath::ConvergenceAlpha(SnapSpeed, deltaTime);
+	UpdatedComponent->MoveComponent(FVector(Offset * SnapAlpha), Rotation, bSweep);
 }
 
 FQuat UPlayerMovementComponent::GetClimbingRotation(float deltaTime) const
 {
-	const FQuat CurrentRotation = UpdatedComponent->GetComponentQuat();
-	const FQuat TargetRotation = FRotationMatrix::MakeFromX(-CurrentClimbingNormal).ToQuat();
+	const FQuat4f CurrentRotation = FQuat4f(UpdatedComponent->GetComponentQuat());
 
-	const float RotationSpeed = ClimbingRotationSpeed * FMath::Max(1,Velocity.Length()/MaxClimbingSpeed);
+	const UClimbingProfile& Profile = GetClimbingProfile();
+	const float RotationSpeed = Profile.ClimbingRotationSpeed * ClimbingSolverMath::SpeedScale((float)Velocity.Length(), Profile.InvMaxClimbingSpeed);
 
-	return FMath::QInterpTo(CurrentRotation, TargetRotation, deltaTime, RotationSpeed);
+	//QInterpTo steps linearly with deltaTime, which overshoots at low frame rates
+	const float RotationAlpha = ClimbingSolverMath::ConvergenceAlpha(RotationSpeed, deltaTime);
+	return FQuat(ClimbingSolverMath::ClimbingRotation(CurrentRotation, FVector3f(CurrentClimbingNormal), RotationAlpha));
 }
 
 bool UPlayerMovementComponent::ClimbDownToFloor() const
@@ -469,7 +1312,7 @@ bool UPlayerMovementComponent::ClimbDownToFloor() const
 	const bool bOnWalkableFloor = FloorHit.Normal.Z > GetWalkableFloorZ();
 
 	const float DownSpeed = FVector::DotProduct(Velocity, -FloorHit.Normal);
-	const bool bIsMovingTowardsFloor = DownSpeed >= MinClimbDownThreshold && bOnWalkableFloor;
+	const bool bIsMovingTowardsFloor = DownSpeed >= GetClimbingProfile().MinClimbDownThreshold && bOnWalkableFloor;
 	const bool bIsClimbingFloor = CurrentClimbingNormal.Z > GetWalkableFloorZ();
 
 	return bIsMovingTowardsFloor || (bIsClimbingFloor && bOnWalkableFloor);
@@ -478,22 +1321,28 @@ bool UPlayerMovementComponent::ClimbDownToFloor() const
 bool UPlayerMovementComponent::CheckFloor(FHitResult& FloorHit) const
 {
 	const FVector StartLocation = UpdatedComponent->GetComponentLocation();
-	const FVector EndLocation = StartLocation + FVector::DownVector * FloorCheckDistance;
+	const FVector EndLocation = StartLocation + FVector::DownVector * GetClimbingProfile().FloorCheckDistance;
 
-	return GetWorld()->LineTraceSingleByChannel(FloorHit,StartLocation, EndLocation, ECC_WorldStatic, ClimbingQueryParameters);
+	return ClimbingLineTrace(FloorHit, StartLocation, EndLocation);
 }
 
 bool UPlayerMovementComponent::TryClimbUpLedge(float deltaTime, int32 Iterations)
 {
 	const float UpSpeed = FVector::DotProduct(Velocity, UpdatedComponent->GetUpVector());
-	const bool bIsMovingUp = UpSpeed >= MinClimbLedgeThreshold;
+	const bool bIsMovingUp = UpSpeed >= GetClimbingProfile().MinClimbLedgeThreshold;
+
+	//this runs every substep, so skip the traces when we can't be climbing up anyway
+	if (!bIsMovingUp)
+	{
+		return false;
+	}
 
 	//store checks here
 	FVector CharacterStandingLocation;
 
 	bool bHasReachedEdge = HasReachedEdge(LastEdgeLocation);
 	bool bCanMoveToLedgeClimbLocation = CanMoveToLedgeClimbLocation(CharacterStandingLocation);
-	if (bIsMovingUp && bCanMoveToLedgeClimbLocation && bHasReachedEdge)	
+	if (bCanMoveToLedgeClimbLocation && bHasReachedEdge)
 	{
 		//place character upright and on the location that we checked
 		StopClimbing(deltaTime,Iterations);
@@ -520,13 +1369,16 @@ bool UPlayerMovementComponent::IsLocationWalkable(const FVector& CheckLocation)
 	const FVector CheckEnd = CheckLocation + (FVector::DownVector * 350.f);
 
 	FHitResult LedgeHit;
-	const bool bHitLedgeGround = GetWorld()->LineTraceSingleByChannel(LedgeHit, CheckLocation, CheckEnd, ECC_WorldStatic, ClimbingQueryParameters);
+	const bool bHitLedgeGround = ClimbingLineTrace(LedgeHit, CheckLocation, CheckEnd);
 
-	FColor ResultColor = bHitLedgeGround && LedgeHit.Normal.Z >= GetWalkableFloorZ() ? FColor::Green : FColor::Red;
-	UKismetSystemLibrary::DrawDebugLine(GetWorld(), CheckLocation, CheckEnd, ResultColor);
-	if (bHitLedgeGround)
+	if (ShouldDrawDebug())
 	{
-		UKismetSystemLibrary::DrawDebugSphere(GetWorld(), LedgeHit.ImpactPoint, 10);
+		FColor ResultColor = bHitLedgeGround && LedgeHit.Normal.Z >= GetWalkableFloorZ() ? FColor::Green : FColor::Red;
+		UKismetSystemLibrary::DrawDebugLine(GetWorld(), CheckLocation, CheckEnd, ResultColor);
+		if (bHitLedgeGround)
+		{
+			UKismetSystemLibrary::DrawDebugSphere(GetWorld(), LedgeHit.ImpactPoint, 10);
+		}
 	}
 
 	return bHitLedgeGround && LedgeHit.Normal.Z >= GetWalkableFloorZ();
@@ -548,11 +1400,14 @@ bool UPlayerMovementComponent::CanMoveToLedgeClimbLocation(FVector& CharacterSta
 	FHitResult CapsuleHit;
 
 	const FVector CapsuleStartLocation = CharacterStandingLocation - HorizontalOffset;
-	const bool bClimbingLocationBlocked = GetWorld()->SweepSingleByChannel(CapsuleHit, CapsuleStartLocation, CharacterStandingLocation, FQuat::Identity, ECC_WorldStatic, Capsule->GetCollisionShape(), ClimbingQueryParameters);
+	const bool bClimbingLocationBlocked = ClimbingSweep(CapsuleHit, CapsuleStartLocation, CharacterStandingLocation, FQuat::Identity, Capsule->GetCollisionShape());
 
 	//Debug Drawing Capsule Cast
-	FColor ResultColor = bClimbingLocationBlocked ? FColor::Red : FColor::Green;
-	UKismetSystemLibrary::DrawDebugCapsule(GetWorld(), CharacterStandingLocation, Capsule->GetScaledCapsuleHalfHeight(), Capsule->GetScaledCapsuleRadius(), FRotator::ZeroRotator, ResultColor);
+	if (ShouldDrawDebug())
+	{
+		FColor ResultColor = bClimbingLocationBlocked ? FColor::Red : FColor::Green;
+		UKismetSystemLibrary::DrawDebugCapsule(GetWorld(), CharacterStandingLocation, Capsule->GetScaledCapsuleHalfHeight(), Capsule->GetScaledCapsuleRadius(), FRotator::ZeroRotator, ResultColor);
+	}
 
 	return !bClimbingLocationBlocked;
 }
@@ -561,8 +1416,7 @@ void UPlayerMovementComponent::StoreClimbDashDirection()
 {
 	ClimbDashDirection = UpdatedComponent->GetUpVector();
 
-	const float AccelerationThreshold = MaxClimbingAcceleration / 10;
-	if (Acceleration.Length() > AccelerationThreshold)
+	if (Acceleration.Length() > GetClimbingProfile().ClimbDashAccelerationThreshold)
 	{
 		ClimbDashDirection = Acceleration.GetSafeNormal();
 	}
@@ -577,7 +1431,7 @@ void UPlayerMovementComponent::UpdateClimbDashState(float deltaTime)
 
 	//better to cache it when dash starts
 	float MinTime, MaxTime;
-	ClimbDashCurve->GetTimeRange(MinTime, MaxTime);
+	GetClimbingProfile().ClimbDashCurve->GetTimeRange(MinTime, MaxTime);
 
 	if (CurrentClimbDashTime >= MaxTime)
 	{
@@ -587,9 +1441,15 @@ void UPlayerMovementComponent::UpdateClimbDashState(float deltaTime)
 
 void UPlayerMovementComponent::StopClimbDashing()
 {
+	const bool bWasClimbDashing = bIsClimbDashing;
 	bWantsToClimbDash = false;
 	bIsClimbDashing = false;
 	CurrentClimbDashTime = 0;
+
+	if (bWasClimbDashing)
+	{
+		OnClimbDashStateChanged.Broadcast(false);
+	}
 }
 
 void UPlayerMovementComponent::AlignClimbDashDirection()
@@ -601,42 +1461,132 @@ void UPlayerMovementComponent::AlignClimbDashDirection()
 
 void UPlayerMovementComponent::CheckForGrapplePoint()
 {
-	bCanGrapple = false;
+	const bool bHadGrapplePoint = bCanGrapple;
+	const AActor* PreviousGrappleTarget = ActorToGrapple;
+	bCanGrapple = FindGrapplePoint();
+
+	//the point slides around as the camera moves, listeners only hear about gaining, losing or switching the target
+	if (bCanGrapple != bHadGrapplePoint || (bCanGrapple && ActorToGrapple != PreviousGrappleTarget))
+	{
+		OnGrappleTargetChanged.Broadcast(bCanGrapple, LastValidGrapplePoint, ActorToGrapple);
+	}
+}
+
+bool UPlayerMovementComponent::FindGrapplePoint()
+{
 	//do two casts, a line cast first to see if the player is directly aiming at something
 	//second, a sphere cast to give a little assistance in case they miss directly
-	APlayerCameraManager* Camera = GetWorld()->GetFirstPlayerController()->PlayerCameraManager;
-	FVector RaycastDirection = Camera->GetActorForwardVector();
-	FVector RaycastStartingPoint = Camera->GetCameraLocation() + (RaycastDirection * 600);
+	//player controllers report their camera here, AI controllers report the pawn's eyes
+	AController* Controller = CharacterOwner->GetController();
+	if (!Controller)
+		return false;
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	Controller->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	FVector RaycastDirection = ViewRotation.Vector();
+	FVector RaycastStartingPoint = ViewLocation + (RaycastDirection * GrappleRaycastStartOffset);
 	FVector RaycastEndingPoint = RaycastStartingPoint + (RaycastDirection * GrappleDistance);
 	
 	
 	//this takes advantage of short circuiting so if the line trace fails it will try the sphere trace.
 	//if the line trace succeeds the sphere trace doesnt' happen
 	FHitResult Hit;
-	if (GetWorld()->LineTraceSingleByChannel(Hit, RaycastStartingPoint, RaycastEndingPoint, ECC_WorldStatic, ClimbingQueryParameters))
-	{
-		bCanGrapple = true;
-	}
+	bool bFoundGrapplePoint = ClimbingLineTrace(Hit, RaycastStartingPoint, RaycastEndingPoint);
 
-	if (!bCanGrapple)
+	if (!bFoundGrapplePoint)
 	{
 		for (float currentRadius = 0.1f; currentRadius < MaxGrappleAssistRadius; currentRadius += GrappleAssistPrecision)
 		{
 			const FCollisionShape CollisionSphere = FCollisionShape::MakeSphere(currentRadius);
-			if (GetWorld()->SweepSingleByChannel(Hit, RaycastStartingPoint, RaycastEndingPoint - (RaycastDirection * currentRadius), FQuat::Identity, ECC_WorldStatic, CollisionSphere, ClimbingQueryParameters))
+			if (ClimbingSweep(Hit, RaycastStartingPoint, RaycastEndingPoint - (RaycastDirection * currentRadius), FQuat::Identity, CollisionSphere))
 			{
-				bCanGrapple = true;
+				bFoundGrapplePoint = true;
 				break;
 			}
 		}
 	}
-	if (!bCanGrapple)
-		return;
+	//if all fails, get out
+	if (!bFoundGrapplePoint)
+		return false;
 
 	LastValidGrapplePoint = Hit.ImpactPoint;
 	ActorToGrapple = Hit.GetActor();
-	UKismetSystemLibrary::DrawDebugLine(GetWorld(), UpdatedComponent->GetComponentLocation(), Hit.ImpactPoint, FColor::Green);
-	
-	//if all fails, get out
-	
+	if (ShouldDrawDebug())
+	{
+		UKismetSystemLibrary::DrawDebugLine(GetWorld(), UpdatedComponent->GetComponentLocation(), Hit.ImpactPoint, FColor::Green);
+	}
+	return true;
+}
+
+void FSavedMove_PlayerMovement::Clear()
+{
+	Super::Clear();
+
+	bSavedWantsToClimb = false;
+	bSavedWantsToClimbDash = false;
+	bSavedIsClimbDashing = false;
+	SavedClimbDashTime = 0;
+	SavedClimbDashDirection = FVector::ZeroVector;
+}
+
+uint8 FSavedMove_PlayerMovement::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+
+	if (bSavedWantsToClimb)
+	{
+		Result |= FLAG_Custom_0;
+	}
+	if (bSavedWantsToClimbDash)
+	{
+		Result |= FLAG_Custom_1;
+	}
+
+	return Result;
+}
+
+bool FSavedMove_PlayerMovement::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FSavedMove_PlayerMovement* NewPlayerMove = static_cast<const FSavedMove_PlayerMovement*>(NewMove.Get());
+	if (bSavedWantsToClimb != NewPlayerMove->bSavedWantsToClimb || bSavedWantsToClimbDash != NewPlayerMove->bSavedWantsToClimbDash)
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_PlayerMovement::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	if (const UPlayerMovementComponent* MovementComponent = Cast<UPlayerMovementComponent>(C->GetCharacterMovement()))
+	{
+		bSavedWantsToClimb = MovementComponent->bWantsToClimb;
+		bSavedWantsToClimbDash = MovementComponent->bWantsToClimbDash;
+		//a replayed move has to start the dash where the original did, the flags alone only say it was wanted
+		bSavedIsClimbDashing = MovementComponent->bIsClimbDashing;
+		SavedClimbDashTime = MovementComponent->CurrentClimbDashTime;
+		SavedClimbDashDirection = MovementComponent->ClimbDashDirection;
+	}
+}
+
+void FSavedMove_PlayerMovement::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	if (UPlayerMovementComponent* MovementComponent = Cast<UPlayerMovementComponent>(C->GetCharacterMovement()))
+	{
+		MovementComponent->bWantsToClimb = bSavedWantsToClimb;
+		MovementComponent->bWantsToClimbDash = bSavedWantsToClimbDash;
+		MovementComponent->bIsClimbDashing = bSavedIsClimbDashing;
+		MovementComponent->CurrentClimbDashTime = SavedClimbDashTime;
+		MovementComponent->ClimbDashDirection = SavedClimbDashDirection;
+	}
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_PlayerMovement::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_PlayerMovement());
 }
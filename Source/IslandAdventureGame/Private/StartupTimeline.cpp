@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "StartupTimeline.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/DateTime.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY(LogStartupTimeline);
+
+double FStartupTimeline::MilestoneSeconds[(uint8)EStartupMilestone::Num] = {};
+bool FStartupTimeline::bFlushed = false;
+
+static const TCHAR* GetMilestoneName(EStartupMilestone Milestone)
+{
+	switch (Milestone)
+	{
+	case EStartupMilestone::MapLoaded:			return TEXT("MapLoaded");
+	case EStartupMilestone::PawnPossessed:		return TEXT("PawnPossessed");
+	case EStartupMilestone::FirstInputAccepted:	return TEXT("FirstInputAccepted");
+	default:									return TEXT("Unknown");
+	}
+}
+
+void FStartupTimeline::Mark(EStartupMilestone Milestone)
+{
+	double& Seconds = MilestoneSeconds[(uint8)Milestone];
+	if (bFlushed || Seconds > 0)
+		return;
+
+	//GStartTime is taken as the very first thing the engine does, so this is close enough to process start
+	Seconds = FPlatformTime::Seconds() - GStartTime;
+	UE_LOG(LogStartupTimeline, Log, TEXT("%s reached %.3fs after process start"), GetMilestoneName(Milestone), Seconds);
+
+	if (Milestone == EStartupMilestone::FirstInputAccepted)
+	{
+		Flush();
+	}
+}
+
+void FStartupTimeline::Flush()
+{
+	bFlushed = true;
+
+	FString Row = FString::Printf(TEXT("%s,%u,%s"), FApp::GetBuildVersion(), FEngineVersion::Current().GetChangelist(), *FDateTime::UtcNow().ToIso8601());
+	FString Header = TEXT("BuildVersion,Changelist,TimestampUtc");
+	for (uint8 Index = 0; Index < (uint8)EStartupMilestone::Num; Index++)
+	{
+		Header += FString::Printf(TEXT(",%s"), GetMilestoneName((EStartupMilestone)Index));
+		Row += FString::Printf(TEXT(",%.3f"), MilestoneSeconds[Index]);
+	}
+
+	UE_LOG(LogStartupTimeline, Log, TEXT("Time to interactive: %s"), *Row);
+
+	const FString CsvPath = FPaths::ProfilingDir() / TEXT("StartupTimeline.csv");
+	if (!IFileManager::Get().FileExists(*CsvPath))
+	{
+		FFileHelper::SaveStringToFile(Header + LINE_TERMINATOR, *CsvPath);
+	}
+	FFileHelper::SaveStringToFile(Row + LINE_TERMINATOR, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
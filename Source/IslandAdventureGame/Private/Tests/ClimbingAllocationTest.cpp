@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "HAL/MemoryBase.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "PlayerMovementComponent.h"
+#include "IslandAdventureGameCharacter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ClimbingAllocationTest
+{
+	/** Forwards everything to the real allocator and counts allocations made on the game thread while installed */
+	class FAllocationCounter final : public FMalloc
+	{
+	public:
+		void Install()
+		{
+			NumAllocations = 0;
+			Inner = GMalloc;
+			GMalloc = this;
+		}
+
+		void Uninstall()
+		{
+			GMalloc = Inner;
+		}
+
+		int32 GetNumAllocations() const { return NumAllocations; }
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			Record();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			//a realloc to zero is a free
+			if (Count > 0)
+			{
+				Record();
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("ClimbingAllocationCounter"); }
+
+	private:
+		//the render and worker threads keep allocating while we measure, only the game thread runs the climbing tick
+		void Record()
+		{
+			if (IsInGameThread())
+			{
+				NumAllocations++;
+			}
+		}
+
+		FMalloc* Inner = nullptr;
+		int32 NumAllocations = 0;
+	};
+
+	//other threads can still be inside a call through GMalloc just after it is swapped back, so this never goes away
+	static FAllocationCounter AllocationCounter;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbingSteadyStateAllocationTest, "IslandAdventure.Climbing.NoHeapAllocationsWhileClimbing",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FClimbingSteadyStateAllocationTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	//a wall just in reach of the wall sweep, the character floats in front of it facing in
+	AStaticMeshActor* Wall = World->SpawnActor<AStaticMeshActor>(FVector(150, 0, 0), FRotator::ZeroRotator);
+	Wall->SetMobility(EComponentMobility::Movable);
+	Wall->GetStaticMeshComponent()->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+	Wall->SetActorScale3D(FVector(1, 10, 10));
+
+	AIslandAdventureGameCharacter* Character = World->SpawnActor<AIslandAdventureGameCharacter>(FVector(0, 0, 0), FRotator::ZeroRotator);
+	UPlayerMovementComponent* Movement = Character->GetPlayerMovementComponent();
+	Movement->bRunPhysicsWithNoController = true;
+
+	//what one frame does for a climbing character: the probe stage, then the movement tick
+	//the cache is emptied by hand because GFrameCounter doesn't move while the test runs
+	const float DeltaTime = 1.f / 60.f;
+	auto TickClimbing = [Movement, DeltaTime]()
+	{
+		Movement->QueryCache.Invalidate();
+		Movement->TickWallProbe();
+		Movement->TickComponent(DeltaTime, LEVELTICK_All, &Movement->PrimaryComponentTick);
+	};
+
+	Movement->SweepAndStoreWallHits();
+	Movement->TryClimbing();
+	TestTrue(TEXT("Character can grab the wall"), Movement->bWantsToClimb);
+
+	//the first climbing ticks size the scratch storage
+	for (int32 Frame = 0; Frame < 10; Frame++)
+	{
+		TickClimbing();
+	}
+	TestTrue(TEXT("Character is climbing"), Movement->IsClimbing());
+
+	ClimbingAllocationTest::AllocationCounter.Install();
+	for (int32 Frame = 0; Frame < 60; Frame++)
+	{
+		TickClimbing();
+	}
+	ClimbingAllocationTest::AllocationCounter.Uninstall();
+
+	TestEqual(TEXT("Heap allocations in 60 steady state climbing ticks"), ClimbingAllocationTest::AllocationCounter.GetNumAllocations(), 0);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif
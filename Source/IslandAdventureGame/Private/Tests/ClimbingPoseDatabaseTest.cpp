@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "ClimbingPoseDatabase.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ClimbingPoseDatabaseTest
+{
+	static FClimbingPoseQuery MakeQuery(float Speed, float Lean)
+	{
+		FClimbingPoseQuery Query;
+		Query.Features[2] = Speed;
+		Query.Features[4] = Lean;
+		return Query;
+	}
+
+	//a slow climb whose speed ramps up over its samples, enough of them to split the tree a few times
+	static TArray<FClimbingPoseSample> MakeClimbClip(int32 NumSamples, float SampleRate)
+	{
+		TArray<FClimbingPoseSample> Samples;
+		for (int32 Frame = 0; Frame < NumSamples; Frame++)
+		{
+			FClimbingPoseSample& Sample = Samples.AddDefaulted_GetRef();
+			Sample.Features = MakeQuery(Frame * 0.05f, 0.f);
+			Sample.Time = Frame / SampleRate;
+		}
+		return Samples;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbingPoseDatabaseLookupTest, "IslandAdventure.Climbing.PoseDatabaseLookup",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FClimbingPoseDatabaseLookupTest::RunTest(const FString& Parameters)
+{
+	using namespace ClimbingPoseDatabaseTest;
+
+	UClimbingPoseDatabase* Database = NewObject<UClimbingPoseDatabase>();
+	int32 Clip = INDEX_NONE;
+	float Time = 0;
+
+	//nothing indexed yet, with and without a pose playing
+	TestFalse(TEXT("Empty database finds no pose"), Database->FindBestPose(MakeQuery(0, 0), INDEX_NONE, 0, Clip, Time));
+	TestFalse(TEXT("Empty database ignores the playing clip"), Database->FindBestPose(MakeQuery(0, 0), 0, 0, Clip, Time));
+
+	//a ramping climb and a single leaning pose, the clips need no sequences once they are sampled
+	Database->Clips.SetNum(2);
+	TArray<TArray<FClimbingPoseSample>> ClipSamples;
+	ClipSamples.Add(MakeClimbClip(40, Database->SampleRate));
+	FClimbingPoseSample& LeanSample = ClipSamples.AddDefaulted_GetRef().AddDefaulted_GetRef();
+	LeanSample.Features = MakeQuery(0.f, 1.f);
+	Database->BuildIndexFromSamples(ClipSamples);
+
+	//first lookup, nothing playing
+	TestTrue(TEXT("Finds a pose with nothing playing"), Database->FindBestPose(MakeQuery(1.f, 0.f), INDEX_NONE, 0, Clip, Time));
+	TestEqual(TEXT("Picks the climb"), Clip, 0);
+	TestEqual(TEXT("Picks the climb frame with the matching speed"), Time, 20 / Database->SampleRate, KINDA_SMALL_NUMBER);
+
+	//a clip past the end of the list is treated as nothing playing
+	TestTrue(TEXT("Finds a pose with an unknown clip playing"), Database->FindBestPose(MakeQuery(0.f, 1.f), 5, 0, Clip, Time));
+	TestEqual(TEXT("Picks the lean"), Clip, 1);
+
+	//the playing pose is kept when another one is only marginally better
+	const float ClimbTime = 10 / Database->SampleRate;
+	TestTrue(TEXT("Finds a pose with the climb playing"), Database->FindBestPose(MakeQuery(0.51f, 0.f), 0, ClimbTime, Clip, Time));
+	TestEqual(TEXT("Keeps the climb"), Clip, 0);
+	TestEqual(TEXT("Keeps the climb frame"), Time, ClimbTime, KINDA_SMALL_NUMBER);
+
+	//and left when another one is clearly better
+	TestTrue(TEXT("Finds a pose leaving the climb"), Database->FindBestPose(MakeQuery(0.f, 1.f), 0, ClimbTime, Clip, Time));
+	TestEqual(TEXT("Jumps to the lean"), Clip, 1);
+
+	return true;
+}
+
+#endif
@@ -6,6 +6,8 @@
 #include "GameFramework/Actor.h"
 #include "ActorAnchor.generated.h"
 
+class UAnchorBehaviorSubsystem;
+
 UCLASS()
 class ISLANDADVENTUREGAME_API AActorAnchor : public AActor
 {
@@ -16,13 +18,19 @@ public:
 	AActorAnchor();
 	void InitAnchor(FVector Location, AActor* ActorToAttachTo);
 	void UpdateAnchorLocation(FVector NewLocation);
+	/** Keeps the anchor at its current offset from Base as Base moves */
+	void FollowBase(USceneComponent* Base);
+	/** Starts reeling the anchor in towards Target, it is destroyed once it arrives */
+	void Retract(FVector Target);
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+private:
+	friend class UAnchorBehaviorSubsystem;
 
+	//slot in UAnchorBehaviorSubsystem, kept up to date by the subsystem as slots are compacted
+	int32 BehaviorIndex = INDEX_NONE;
 };
@@ -6,7 +6,21 @@
 #include "Components/ActorComponent.h"
 #include "AnchorBehaviorComponent.generated.h"
 
+UENUM(BlueprintType)
+enum class EAnchorBehavior : uint8
+{
+	//stays where it was placed
+	Static,
+	//keeps its offset to whatever it was attached to, for anchors on moving platforms
+	FollowBase,
+	//reels in towards its retract target and is destroyed when it gets there
+	Retract,
+};
 
+/**
+ * Describes how an anchor behaves once it is placed. The component does not tick itself, the anchor hands these settings
+ * to UAnchorBehaviorSubsystem which updates every anchor in the world in one batched pass.
+ */
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class ISLANDADVENTUREGAME_API UAnchorBehaviorComponent : public UActorComponent
 {
@@ -16,13 +30,11 @@ public:
 	// Sets default values for this component's properties
 	UAnchorBehaviorComponent();
 
-protected:
-	// Called when the game starts
-	virtual void BeginPlay() override;
-
-public:	
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
-
-		
+	UPROPERTY(Category = "Anchor", EditAnywhere, BlueprintReadOnly)
+		EAnchorBehavior Behavior = EAnchorBehavior::FollowBase;
+	UPROPERTY(Category = "Anchor", EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0.0", EditCondition = "Behavior == EAnchorBehavior::Retract"))
+		float RetractSpeed = 1500.f;
+	//the anchor breaks after this many seconds, 0 keeps it forever
+	UPROPERTY(Category = "Anchor", EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0.0"))
+		float BreakAfterSeconds = 0.f;
 };
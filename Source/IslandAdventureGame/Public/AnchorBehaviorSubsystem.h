@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AnchorBehaviorComponent.h"
+#include "AnchorBehaviorSubsystem.generated.h"
+
+class AActorAnchor;
+
+/**
+ * Updates every grapple anchor in the world in one pass instead of one tick per anchor.
+ * Behaviour state is kept in flat arrays indexed by the anchor's slot. Each frame the bases are sampled on the game thread,
+ * the behaviours run over the arrays (in parallel once there are enough anchors), and the moved anchors are written back in a single sweep.
+ */
+UCLASS()
+class ISLANDADVENTUREGAME_API UAnchorBehaviorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override { return States.Num() > 0; }
+
+	void RegisterAnchor(AActorAnchor* Anchor);
+	void UnregisterAnchor(AActorAnchor* Anchor);
+	void SetAnchorBase(AActorAnchor* Anchor, USceneComponent* Base);
+	void SetAnchorLocation(AActorAnchor* Anchor, const FVector& Location);
+	void RetractAnchor(AActorAnchor* Anchor, const FVector& Target);
+
+	FORCEINLINE int32 GetNumAnchors() const { return States.Num(); }
+
+private:
+	struct FAnchorBehaviorState
+	{
+		FVector Location;
+		//offset in the base's space, only used while following a base
+		FVector LocalOffset;
+		FVector RetractTarget;
+		float RetractSpeed;
+		float BreakAfterSeconds;
+		float Age;
+		EAnchorBehavior Behavior;
+		bool bHasBase;
+		bool bMoved;
+		bool bExpired;
+	};
+
+	void UpdateState(FAnchorBehaviorState& State, const FTransform& BaseTransform, float DeltaTime) const;
+
+	//all indexed by the anchor's BehaviorIndex, removal swaps the last slot in
+	TArray<FAnchorBehaviorState> States;
+	TArray<TWeakObjectPtr<USceneComponent>> Bases;
+	TArray<FTransform> BaseTransforms;
+	UPROPERTY()
+		TArray<TObjectPtr<AActorAnchor>> Anchors;
+};
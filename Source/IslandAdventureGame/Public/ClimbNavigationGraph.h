@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ClimbNavigationGraph.generated.h"
+
+class UBoxComponent;
+class UClimbingProfile;
+class UNavLinkCustomComponent;
+
+USTRUCT()
+struct FClimbNavNode
+{
+	GENERATED_BODY()
+
+	//where the character's centre sits while climbing here
+	UPROPERTY()
+		FVector Location = FVector::ZeroVector;
+	UPROPERTY()
+		FVector Normal = FVector::ZeroVector;
+	UPROPERTY()
+		int32 Cluster = INDEX_NONE;
+	UPROPERTY()
+		int32 FirstEdge = 0;
+	UPROPERTY()
+		int32 NumEdges = 0;
+};
+
+USTRUCT()
+struct FClimbNavEdge
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		int32 To = INDEX_NONE;
+	UPROPERTY()
+		float Cost = 0;
+};
+
+USTRUCT()
+struct FClimbNavCluster
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		FVector Center = FVector::ZeroVector;
+	UPROPERTY()
+		int32 FirstNode = 0;
+	UPROPERTY()
+		int32 NumNodes = 0;
+	UPROPERTY()
+		int32 FirstNeighbor = 0;
+	UPROPERTY()
+		int32 NumNeighbors = 0;
+};
+
+/** A climb from a wall foot on the navmesh to a ledge top on the navmesh, exposed to pathfinding as a custom nav link */
+USTRUCT()
+struct FClimbNavLink
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+		int32 EntryNode = INDEX_NONE;
+	UPROPERTY()
+		int32 ExitNode = INDEX_NONE;
+	UPROPERTY()
+		FVector Start = FVector::ZeroVector;
+	UPROPERTY()
+		FVector End = FVector::ZeroVector;
+};
+
+/**
+ * Climbable walls inside the volume, sampled into a graph of climb nodes when the graph is built.
+ * Nodes are grouped into clusters so climb paths are planned with a cluster-level search first and a node search
+ * restricted to the resulting corridor second, which keeps planning bounded on large cliffs and never traces.
+ * Each wall foot is tied to the ledge tops it leads to with a custom nav link, so navmesh paths can go over cliffs,
+ * and agents using UClimbPathFollowingComponent climb the link when they reach it.
+ */
+UCLASS()
+class ISLANDADVENTUREGAME_API AClimbNavigationGraph : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AClimbNavigationGraph();
+
+	virtual void PostRegisterAllComponents() override;
+
+	/** Samples the level inside the bounds and rebuilds the graph and its nav links */
+	UFUNCTION(CallInEditor, Category = "Climb Navigation")
+		void BuildGraph();
+
+	/** Node path from StartNode to GoalNode, false when they are not connected or the search budget runs out */
+	bool FindClimbPath(int32 StartNode, int32 GoalNode, TArray<FVector>& OutWaypoints) const;
+
+	FORCEINLINE int32 GetNumNodes() const { return Nodes.Num(); }
+	FORCEINLINE int32 GetNumClusters() const { return Clusters.Num(); }
+	FORCEINLINE const FClimbNavNode& GetNode(int32 Index) const { return Nodes[Index]; }
+
+private:
+	void OnClimbLinkReached(UNavLinkCustomComponent* LinkComponent, UObject* PathingAgent, const FVector& DestPoint);
+	void CreateLinkComponents();
+	bool FindClusterCorridor(int32 StartCluster, int32 GoalCluster, TBitArray<>& OutCorridor) const;
+
+	UPROPERTY(Category = "Climb Navigation", VisibleAnywhere)
+		UBoxComponent* Bounds;
+	//climbing limits the walls are sampled with, the UClimbingProfile defaults when empty
+	UPROPERTY(Category = "Climb Navigation", EditAnywhere)
+		UClimbingProfile* ClimbingProfile;
+	//distance between wall samples, and the longest step between neighbouring nodes
+	UPROPERTY(Category = "Climb Navigation", EditAnywhere, meta = (ClampMin = "25.0", ClampMax = "500.0"))
+		float SampleSpacing = 100.f;
+	UPROPERTY(Category = "Climb Navigation", EditAnywhere, meta = (ClampMin = "200.0"))
+		float ClusterSize = 1000.f;
+	//cap on node expansions for a single climb path
+	UPROPERTY(Category = "Climb Navigation", EditAnywhere, AdvancedDisplay, meta = (ClampMin = "64"))
+		int32 MaxSearchNodes = 4096;
+
+	UPROPERTY()
+		TArray<FClimbNavNode> Nodes;
+	UPROPERTY()
+		TArray<FClimbNavEdge> Edges;
+	UPROPERTY()
+		TArray<FClimbNavCluster> Clusters;
+	UPROPERTY()
+		TArray<int32> ClusterNeighbors;
+	UPROPERTY()
+		TArray<FClimbNavLink> Links;
+
+	//one per entry in Links, recreated whenever the actor's components are registered, so cooked levels get them on load too
+	UPROPERTY(Transient)
+		TArray<UNavLinkCustomComponent*> LinkComponents;
+};
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "ClimbPathFollowingComponent.generated.h"
+
+class UNavLinkCustomComponent;
+
+/**
+ * Path following that can take the climb links placed by AClimbNavigationGraph.
+ * While on a climb link the agent grabs the wall and is steered along the climb path with direct move requests,
+ * the link is handed back once the character has mantled onto the ledge (or let go).
+ */
+UCLASS()
+class ISLANDADVENTUREGAME_API UClimbPathFollowingComponent : public UPathFollowingComponent
+{
+	GENERATED_BODY()
+
+public:
+	void StartClimbPath(UNavLinkCustomComponent* Link, TArray<FVector>&& Waypoints, const FVector& WallNormal);
+	FORCEINLINE bool IsFollowingClimbPath() const { return ActiveClimbLink != nullptr; }
+
+protected:
+	virtual void UpdatePathSegment() override;
+	virtual void FollowPathSegment(float DeltaTime) override;
+	virtual void OnPathFinished(const FPathFollowingResult& Result) override;
+
+private:
+	void FollowClimbPath(float DeltaTime);
+	void FinishClimbPath();
+
+	UPROPERTY(Category = "Climbing", EditAnywhere)
+		float ClimbWaypointAcceptanceRadius = 60.f;
+	//a climb that takes longer than this gives up on the link
+	UPROPERTY(Category = "Climbing", EditAnywhere)
+		float ClimbLinkTimeout = 30.f;
+
+	UPROPERTY(Transient)
+		UNavLinkCustomComponent* ActiveClimbLink = nullptr;
+	TArray<FVector> ClimbWaypoints;
+	FVector ClimbWallNormal;
+	int32 CurrentClimbWaypoint = 0;
+	float ClimbTime = 0;
+	bool bHasGrabbedWall = false;
+};
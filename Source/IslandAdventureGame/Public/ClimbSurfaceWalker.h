@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UPrimitiveComponent;
+class UBodySetup;
+
+/**
+ * Collision triangles of a static mesh with edge adjacency and smoothed vertex normals, built once per body setup from its
+ * cooked complex collision and shared by every climber on that mesh.
+ */
+struct ISLANDADVENTUREGAME_API FClimbSurfaceMesh
+{
+	TArray<FVector3f> Vertices;
+	TArray<FVector3f> VertexNormals;
+	TArray<FIntVector> Triangles;
+	//triangle across each edge (i, i + 1), INDEX_NONE on open edges
+	TArray<FIntVector> Neighbours;
+
+	/** Shared mesh for the component's collision, null when it has no complex collision triangles. Dropped from the cache once every component it was handed to is unregistered */
+	static TSharedPtr<const FClimbSurfaceMesh> Get(const UPrimitiveComponent& Component);
+
+	/** Every triangle whose bounds come within Radius of the local space Point, and possibly a few more. May list a triangle twice */
+	void GatherTriangles(const FVector3f& Point, float Radius, TArray<int32>& OutTriangles) const;
+
+private:
+	static TSharedPtr<const FClimbSurfaceMesh> Build(const UBodySetup& BodySetup);
+	void BuildTriangleGrid();
+	FIntVector GetCell(const FVector3f& Point) const;
+
+	//triangles spanning more cells than this are kept out of the grid and always gathered, a query over more cells scans the whole mesh
+	static constexpr int32 MaxGridCellsPerTriangle = 64;
+	static constexpr int32 MaxGridCellsPerQuery = 64;
+
+	//about one triangle across
+	float GridCellSize = 1.f;
+	TMap<FIntVector, TArray<int32>> TriangleGrid;
+	TArray<int32> LargeTriangles;
+};
+
+/**
+ * Keeps a climber's contact point on a collision mesh and moves it across triangle edges as the climber moves,
+ * so the surface under the character is known without sweeping for it again. The walk gives up, and the caller should
+ * probe the scene, when it runs off the mesh or over a crease sharper than the climbing rules allow.
+ */
+class ISLANDADVENTUREGAME_API FClimbSurfaceWalker
+{
+public:
+	/** Attaches to the triangle closest to WorldPoint, normals are oriented towards Viewpoint. False when nothing is within MaxDistance */
+	bool Attach(const UPrimitiveComponent* InComponent, const FVector& WorldPoint, const FVector& Viewpoint, float MaxDistance);
+	void Detach();
+	bool IsAttached() const { return Mesh.IsValid() && Component.IsValid(); }
+	const UPrimitiveComponent* GetComponent() const { return Component.Get(); }
+
+	/** Moves the contact point by WorldDelta along the surface. False when it left the mesh or met a crease with a cosine below MinCreaseCos */
+	bool Walk(const FVector& WorldDelta, float MinCreaseCos);
+
+	FVector GetWorldPoint() const;
+	/** Surface normal at the contact point, interpolated from the vertex normals and facing the climber */
+	FVector GetWorldNormal() const;
+
+private:
+	void GetWorldTriangle(const FTransform& Transform, int32 TriangleIndex, FVector& OutA, FVector& OutB, FVector& OutC) const;
+
+	//a step is one triangle crossed, a frame of climbing normally crosses a handful at most
+	static constexpr int32 MaxWalkSteps = 32;
+
+	TSharedPtr<const FClimbSurfaceMesh> Mesh;
+	TWeakObjectPtr<const UPrimitiveComponent> Component;
+	int32 Triangle = INDEX_NONE;
+	//in component space so the contact stays put if the mesh moves
+	FVector LocalPoint = FVector::ZeroVector;
+	//the collision winding faces away from the climber
+	bool bFlipNormals = false;
+};
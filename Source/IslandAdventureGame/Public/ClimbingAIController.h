@@ -0,0 +1,19 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "ClimbingAIController.generated.h"
+
+/**
+ * AI controller whose path following can take climb links, use it for NPCs that should path over cliffs.
+ */
+UCLASS()
+class ISLANDADVENTUREGAME_API AClimbingAIController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	AClimbingAIController(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+};
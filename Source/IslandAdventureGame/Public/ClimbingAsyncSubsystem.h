@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ClimbingAsyncSubsystem.generated.h"
+
+class FClimbingAsyncCallback;
+
+/** What the game thread hands the physics thread for one climber each frame */
+struct FClimbingAsyncIntent
+{
+	int32 Slot = INDEX_NONE;
+	//bumped by the game thread whenever the physics state has to restart from Location/Rotation/Velocity
+	uint32 ResyncSequence = 0;
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector Velocity = FVector::ZeroVector;
+	FVector Acceleration = FVector::ZeroVector;
+	FVector SurfaceNormal = FVector::ZeroVector;
+	FVector SurfacePosition = FVector::ZeroVector;
+	//bumped every time a dash starts
+	uint32 DashSequence = 0;
+	FVector DashDirection = FVector::ZeroVector;
+
+	//tuning copied out of the climbing profile, the physics thread never touches UObjects
+	float MaxSpeed = 0;
+	float MaxAcceleration = 0;
+	float Deceleration = 0;
+	float InvMaxSpeed = 0;
+	float SnapSpeed = 0;
+	float RotationSpeed = 0;
+	float DistanceFromSurface = 0;
+	float DashDuration = 0;
+	TSharedPtr<const TArray<float>, ESPMode::ThreadSafe> DashSpeedSamples;
+};
+
+/** One climber's simulated state as of a physics step */
+struct FClimbingAsyncResult
+{
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector Velocity = FVector::ZeroVector;
+	//the intent's ResyncSequence the state was stepped from
+	uint32 ResyncSequence = 0;
+	bool bValid = false;
+};
+
+/**
+ * Runs the climbing integration on Chaos's fixed-rate async physics tick.
+ * Characters queue an intent each frame, the physics thread integrates velocity, dash, surface snap and rotation at the physics rate
+ * (stepping on from the last intent when the game thread falls behind), and the game thread reads back results interpolated to the current physics results time.
+ */
+UCLASS()
+class ISLANDADVENTUREGAME_API UClimbingAsyncSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	/** False when the world is not ticking physics asynchronously, callers should stay on the game thread path */
+	FORCEINLINE bool IsAvailable() const { return Callback != nullptr; }
+
+	int32 RegisterClimber();
+	void UnregisterClimber(int32 Slot);
+	void QueueIntent(const FClimbingAsyncIntent& Intent);
+	bool GetInterpolatedResult(int32 Slot, FClimbingAsyncResult& OutResult);
+	/** Unique across every climber, so a reused slot never matches the sequence its previous owner left on the physics thread */
+	FORCEINLINE uint32 NewResyncSequence() { return ++ResyncCounter; }
+
+private:
+	void PullResults();
+
+	FClimbingAsyncCallback* Callback = nullptr;
+	TArray<int32> FreeSlots;
+	int32 NumSlots = 0;
+	uint32 ResyncCounter = 0;
+
+	//the two latest physics results a climber was stepped in, the game thread renders between them
+	struct FSlotResults
+	{
+		FClimbingAsyncResult Previous;
+		FClimbingAsyncResult Latest;
+		double PreviousTime = 0;
+		double LatestTime = 0;
+		//results stepped from an older sequence belong to whoever had the slot before, nothing is taken from a free slot
+		uint32 FirstResyncSequence = MAX_uint32;
+	};
+	//indexed by slot, a step that didn't simulate a slot leaves its last results alone
+	TArray<FSlotResults> SlotResults;
+	uint64 PulledFrame = MAX_uint64;
+};
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IslandAdventureGameGameMode.h"
+#include "ClimbingBenchmarkGameMode.generated.h"
+
+class AIslandAdventureGameCharacter;
+
+/**
+ * Headless scale benchmark for UPlayerMovementComponent. Builds seeded cliff, overhang and ledge geometry, then runs
+ * growing populations of climbing bots and writes world tick percentiles, scene queries per frame and memory per
+ * character to Saved/Profiling/ClimbingBenchmark.csv before exiting.
+ *
+ * Usage: IslandAdventureGame /Engine/Maps/Entry?game=/Script/IslandAdventureGame.ClimbingBenchmarkGameMode?Seed=7?Populations=1+10+100+500 -nullrhi -nosound -unattended
+ */
+UCLASS()
+class ISLANDADVENTUREGAME_API AClimbingBenchmarkGameMode : public AIslandAdventureGameGameMode
+{
+	GENERATED_BODY()
+
+public:
+	AClimbingBenchmarkGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
+
+private:
+	enum class EPhase : uint8
+	{
+		WarmingUp,
+		Sampling,
+		Finished
+	};
+
+	struct FPopulationResult
+	{
+		int32 Population = 0;
+		int32 Frames = 0;
+		double P50Ms = 0;
+		double P95Ms = 0;
+		double P99Ms = 0;
+		double QueriesPerFrame = 0;
+		int64 BytesPerCharacter = 0;
+	};
+
+	void GenerateCliffs();
+	void SpawnBlock(const FVector& Location, const FRotator& Rotation, const FVector& SizeInCm);
+	void GrowPopulation(int32 TargetPopulation);
+	void FinishPopulation();
+	void WriteReport() const;
+	uint32 CountSceneQueries() const;
+
+	void OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+	void OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+
+	UPROPERTY(Category = "Benchmark", EditDefaultsOnly)
+		float WarmUpSeconds = 3.f;
+	UPROPERTY(Category = "Benchmark", EditDefaultsOnly)
+		float SampleSeconds = 10.f;
+	UPROPERTY(Category = "Benchmark", EditDefaultsOnly)
+		int32 NumCliffs = 24;
+
+	UPROPERTY(Transient)
+		TArray<TObjectPtr<AIslandAdventureGameCharacter>> Bots;
+
+	TSubclassOf<AIslandAdventureGameCharacter> BotClass;
+	TArray<int32> Populations;
+	int32 PopulationIndex = 0;
+	int32 Seed = 0;
+	FRandomStream Random;
+	//where bots start and which wall they head for, one entry per generated cliff
+	TArray<TPair<FVector, FVector>> ClimbRoutes;
+
+	EPhase Phase = EPhase::WarmingUp;
+	float PhaseTime = 0;
+	double WorldTickStartSeconds = 0;
+	TArray<double> FrameTimesMs;
+	uint32 QueriesAtSampleStart = 0;
+	uint64 MemoryBeforeGrowth = 0;
+	int64 BytesPerCharacter = 0;
+	TArray<FPopulationResult> Results;
+	FDelegateHandle TickStartHandle;
+	FDelegateHandle PostActorTickHandle;
+};
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "ClimbingBotController.generated.h"
+
+/**
+ * Scripted AI that walks to a wall, climbs it, dashes and grapples, then starts over.
+ * Used to put load on UPlayerMovementComponent without a player attached.
+ */
+UCLASS()
+class ISLANDADVENTUREGAME_API AClimbingBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	AClimbingBotController();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** The bot walks from HomeLocation to WallLocation and climbs it, and is sent home again after a while */
+	void SetClimbTarget(const FVector& InHomeLocation, const FVector& InWallLocation, int32 Seed);
+
+private:
+	void SendHome();
+
+	UPROPERTY(Category = "Climbing Bot", EditAnywhere)
+		float ClimbDashesPerSecond = 0.3f;
+	UPROPERTY(Category = "Climbing Bot", EditAnywhere)
+		float GrapplesPerSecond = 0.2f;
+	UPROPERTY(Category = "Climbing Bot", EditAnywhere)
+		float SecondsBeforeReset = 20.f;
+
+	FVector HomeLocation;
+	FVector WallLocation;
+	FRandomStream Random;
+	float TimeSinceReset = 0;
+};
@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ClimbingPoseDatabase.generated.h"
+
+class UAnimSequence;
+class UPlayerMovementComponent;
+
+/** A climbing clip and what the climb looks like while it plays, which root motion alone can't tell */
+USTRUCT(BlueprintType)
+struct FClimbingPoseClip
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Category = "Clip", EditAnywhere)
+		UAnimSequence* Sequence = nullptr;
+	//wall normal the clip was authored against, in character space (a straight wall ahead is -X)
+	UPROPERTY(Category = "Clip", EditAnywhere)
+		FVector SurfaceNormal = FVector(-1, 0, 0);
+	UPROPERTY(Category = "Clip", EditAnywhere)
+		bool bIsClimbDash = false;
+	//share of hands and feet on the wall, below 1 for clips reaching over edges
+	UPROPERTY(Category = "Clip", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "1.0"))
+		float ContactRatio = 1.f;
+};
+
+USTRUCT()
+struct FClimbingPoseKDNode
+{
+	GENERATED_BODY()
+
+	//INDEX_NONE on leaves
+	UPROPERTY()
+		int32 SplitDimension = INDEX_NONE;
+	UPROPERTY()
+		float SplitValue = 0;
+	UPROPERTY()
+		int32 Left = INDEX_NONE;
+	UPROPERTY()
+		int32 Right = INDEX_NONE;
+	//range of points owned by a leaf
+	UPROPERTY()
+		int32 Begin = 0;
+	UPROPERTY()
+		int32 End = 0;
+};
+
+/** The climbing state a pose is matched against, already weighted */
+struct FClimbingPoseQuery
+{
+	static constexpr int32 NumFeatures = 8;
+	alignas(16) float Features[NumFeatures] = {};
+};
+
+/** One sampled frame of a clip */
+struct FClimbingPoseSample
+{
+	FClimbingPoseQuery Features;
+	float Time = 0;
+};
+
+/**
+ * Motion-matching database for climbing. Every clip is sampled into an 8 float feature vector
+ * (local velocity, local surface normal tilt and lean, dash direction, probe contacts) and the samples are stored
+ * leaf by leaf in a KD-tree, so a lookup visits a handful of contiguous leaves and scores each point with two SIMD registers.
+ */
+UCLASS(BlueprintType)
+class ISLANDADVENTUREGAME_API UClimbingPoseDatabase : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/** Resamples the clips and rebuilds the index */
+	UFUNCTION(CallInEditor, Category = "Pose Search")
+		void BuildIndex();
+	/** Rebuilds the index from clips that are already sampled, one array per entry in Clips with the samples 1 / SampleRate apart */
+	void BuildIndexFromSamples(TConstArrayView<TArray<FClimbingPoseSample>> ClipSamples);
+
+	/** Query for the character's current climbing state */
+	FClimbingPoseQuery MakeQuery(const UPlayerMovementComponent& Movement) const;
+
+	/**
+	 * Best clip and time for the query. The pose that is already playing is kept unless another one beats it by ContinuingPoseBias,
+	 * pass INDEX_NONE for CurrentClip when nothing is playing yet.
+	 */
+	bool FindBestPose(const FClimbingPoseQuery& Query, int32 CurrentClip, float CurrentTime, int32& OutClip, float& OutTime) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Pose Search")
+		bool FindClimbingPose(const UPlayerMovementComponent* Movement, int32 CurrentClip, float CurrentTime, int32& OutClip, float& OutTime) const;
+
+	UFUNCTION(BlueprintPure, Category = "Pose Search")
+		UAnimSequence* GetClipSequence(int32 ClipIndex) const { return Clips.IsValidIndex(ClipIndex) ? Clips[ClipIndex].Sequence : nullptr; }
+
+	UPROPERTY(Category = "Pose Search", EditAnywhere)
+		TArray<FClimbingPoseClip> Clips;
+	UPROPERTY(Category = "Pose Search", EditAnywhere, meta = (ClampMin = "5.0", ClampMax = "120.0"))
+		float SampleRate = 30.f;
+	//rotation of the mesh inside the character, brings the clips' root motion into character space
+	UPROPERTY(Category = "Pose Search", EditAnywhere)
+		FRotator MeshRelativeRotation = FRotator(0, -90, 0);
+	//speed the velocity feature is normalised by, normally the profile's MaxClimbingSpeed
+	UPROPERTY(Category = "Pose Search", EditAnywhere, meta = (ClampMin = "1.0"))
+		float ReferenceSpeed = 120.f;
+	UPROPERTY(Category = "Pose Search|Weights", EditAnywhere, meta = (ClampMin = "0.0"))
+		float VelocityWeight = 1.f;
+	UPROPERTY(Category = "Pose Search|Weights", EditAnywhere, meta = (ClampMin = "0.0"))
+		float SurfaceNormalWeight = 0.5f;
+	UPROPERTY(Category = "Pose Search|Weights", EditAnywhere, meta = (ClampMin = "0.0"))
+		float ClimbDashWeight = 1.f;
+	UPROPERTY(Category = "Pose Search|Weights", EditAnywhere, meta = (ClampMin = "0.0"))
+		float ContactWeight = 0.25f;
+	//how much cheaper another pose has to be before we jump away from the one playing
+	UPROPERTY(Category = "Pose Search", EditAnywhere, meta = (ClampMin = "0.0"))
+		float ContinuingPoseBias = 0.05f;
+
+private:
+	void MakeFeatures(const FVector& LocalVelocity, const FVector& LocalNormal, const FVector& LocalDashDirection, float ContactRatio, float* OutFeatures) const;
+	int32 BuildNode(TArray<int32>& Order, int32 Begin, int32 End, const TArray<FClimbingPoseQuery>& Samples);
+
+	static constexpr int32 LeafSize = 16;
+
+	//two vectors per point, in leaf order
+	UPROPERTY()
+		TArray<FVector4f> Points;
+	UPROPERTY()
+		TArray<FClimbingPoseKDNode> Nodes;
+	//clip and time of each point
+	UPROPERTY()
+		TArray<int32> PointClip;
+	UPROPERTY()
+		TArray<float> PointTime;
+	//point index of each clip's samples in time order, for scoring the pose that is playing
+	UPROPERTY()
+		TArray<int32> ClipFirstSample;
+	UPROPERTY()
+		TArray<int32> SamplePoint;
+};
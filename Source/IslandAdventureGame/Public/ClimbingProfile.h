@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ClimbingProfile.generated.h"
+
+class UCurveFloat;
+
+/**
+ * Climbing tuning shared by every character of an archetype. The movement component only keeps a pointer to one of these,
+ * and the values the climbing code compares against every hit (cosines of the angle limits and the like) are worked out here
+ * once on load and whenever the asset is edited, instead of per call.
+ */
+UCLASS(BlueprintType)
+class ISLANDADVENTUREGAME_API UClimbingProfile : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	UPROPERTY(Category = "Climbing", EditAnywhere)
+		int CollisionCapsuleRadius = 50;
+	UPROPERTY(Category = "Climbing", EditAnywhere)
+		int CollisionCapsuleHalfHeight = 72;
+	UPROPERTY(Category = "Climbing", EditAnywhere, meta = (ClampMin = "1.0", ClampMax = "75.0"))
+		float MinSurfaceNormalAngle = 25;
+	UPROPERTY(Category = "Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "180.0"))
+		float MinClimbingAngle = 70;
+	UPROPERTY(Category = "Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "180.0"))
+		float MaxClimbingAngle = 120;
+	UPROPERTY(Category = "Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "80.0"))
+		float ClimbingCollisionShrinkAmount = 30;
+	UPROPERTY(Category = "Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "300.0"))
+		float MaxClimbingSpeed = 120;
+	UPROPERTY(Category = "Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "500.0"))
+		float MaxClimbingAcceleration = 500;
+	UPROPERTY(Category = "Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "600.0"))
+		float ClimbingDeceleration = 600;
+	UPROPERTY(Category = "Climbing", EditAnywhere, meta = (ClampMin = "1.0", ClampMax = "20.0"))
+		float ClimbingRotationSpeed = 6;
+	UPROPERTY(Category = "Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "60.0"))
+		float ClimbingSnapSpeed = 4;
+	UPROPERTY(Category = "Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "80.0"))
+		float DistanceFromSurface = 45;
+	UPROPERTY(Category = "Climbing", EditAnywhere, meta = (ClampMin = "1.0", ClampMax = "500.0"))
+		float FloorCheckDistance = 100;
+	UPROPERTY(Category = "Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "80.0"))
+		float MinClimbDownThreshold = 40;
+	UPROPERTY(Category = "Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "80.0"))
+		float MinClimbLedgeThreshold = 20;
+	UPROPERTY(Category = "Climbing", EditAnywhere)
+		UCurveFloat* ClimbDashCurve;
+	//Climbing is split into substeps no longer than this so it behaves the same at any frame rate
+	UPROPERTY(Category = "Climbing", EditAnywhere, AdvancedDisplay, meta = (ClampMin = "0.0166", ClampMax = "0.50", UIMin = "0.0166", UIMax = "0.50"))
+		float MaxClimbingSimulationTimeStep = 0.05f;
+	//Once this many substeps have been taken the rest of the frame is simulated in one step
+	UPROPERTY(Category = "Climbing", EditAnywhere, AdvancedDisplay, meta = (ClampMin = "1", ClampMax = "25", UIMin = "1", UIMax = "25"))
+		int32 MaxClimbingSimulationIterations = 8;
+	//On a moving base the wall is only probed again once the character has moved this far relative to the base
+	UPROPERTY(Category = "Climbing", EditAnywhere, AdvancedDisplay, meta = (ClampMin = "0.0", ClampMax = "50.0", UIMin = "0.0", UIMax = "50.0"))
+		float ClimbingReprobeDistance = 1.f;
+	//Integrate climbing on the fixed-rate async physics tick instead of the game thread, the game thread only probes and interpolates.
+	//Needs Tick Physics Async in the project's physics settings and is only used in standalone games, other setups keep the game thread path
+	UPROPERTY(Category = "Climbing", EditAnywhere, AdvancedDisplay)
+		bool bSimulateOnAsyncPhysicsTick = false;
+	//Once holding a single static mesh with complex collision, follow its collision triangles instead of sweeping for the wall every frame.
+	//The scene is probed again when the walk runs off the mesh or over a crease sharper than MaxMeshWalkCreaseAngle
+	UPROPERTY(Category = "Climbing", EditAnywhere, AdvancedDisplay)
+		bool bUseMeshWalking = false;
+	UPROPERTY(Category = "Climbing", EditAnywhere, AdvancedDisplay, meta = (ClampMin = "0.0", ClampMax = "90.0", UIMin = "0.0", UIMax = "90.0", EditCondition = "bUseMeshWalking"))
+		float MaxMeshWalkCreaseAngle = 35.f;
+
+	//derived from the values above by RecomputeDerivedValues
+	float CosMinSurfaceNormalAngle;
+	float CosMinClimbingAngle;
+	float CosMaxClimbingAngle;
+	float CosMaxMeshWalkCreaseAngle;
+	float InvMaxClimbingSpeed;
+	float ClimbDashAccelerationThreshold;
+	float ClimbingEyeHeightOffset;
+	//ClimbDashCurve sampled at ClimbDashSampleRate so the physics thread never touches the curve object
+	TSharedPtr<const TArray<float>, ESPMode::ThreadSafe> ClimbDashSpeedSamples;
+	float ClimbDashDuration;
+	static constexpr float ClimbDashSampleRate = 120.f;
+
+	/** Call after setting the values above from code */
+	void RecomputeDerivedValues();
+};
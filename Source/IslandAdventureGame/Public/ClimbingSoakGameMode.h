@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IslandAdventureGameGameMode.h"
+#include "ClimbingSoakGameMode.generated.h"
+
+/**
+ * Server side of the multi-process soak test. Waits for the expected number of clients, then measures server frame time,
+ * per-connection bandwidth and movement corrections for a fixed time and writes them to Saved/Profiling/ClimbingSoak.csv before exiting.
+ * Clients are given AClimbingSoakPlayerController, which drives their character from a script.
+ *
+ * Usage: IslandAdventureGameServer /Game/ThirdPerson/Maps/ThirdPersonMap?game=/Script/IslandAdventureGame.ClimbingSoakGameMode?Clients=8?SoakSeconds=300 -log
+ * Scripts/RunSoakTest.py launches the server and the clients together.
+ */
+UCLASS()
+class ISLANDADVENTUREGAME_API AClimbingSoakGameMode : public AIslandAdventureGameGameMode
+{
+	GENERATED_BODY()
+
+public:
+	AClimbingSoakGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
+
+private:
+	enum class EPhase : uint8
+	{
+		WaitingForClients,
+		Soaking,
+		Finished
+	};
+
+	struct FConnectionStats
+	{
+		TWeakObjectPtr<APlayerController> Player;
+		FString Name;
+		int32 Samples = 0;
+		double OutBytesPerSecondSum = 0;
+		double InBytesPerSecondSum = 0;
+		int32 PeakOutBytesPerSecond = 0;
+		uint32 CorrectionsAtStart = 0;
+		uint32 Corrections = 0;
+	};
+
+	void StartSoak();
+	void SampleConnections();
+	void FinishSoak();
+	void WriteReport() const;
+	static uint32 GetNumCorrections(const APlayerController* Player);
+
+	void OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+	void OnTickFlush(float DeltaSeconds);
+
+	//measuring starts this long after the last client joins, so the join burst isn't counted
+	UPROPERTY(Category = "Soak", EditDefaultsOnly)
+		float SettleSeconds = 10.f;
+	//start anyway with whoever has joined after this long
+	UPROPERTY(Category = "Soak", EditDefaultsOnly)
+		float JoinTimeoutSeconds = 120.f;
+
+	int32 ExpectedClients = 1;
+	float SoakSeconds = 300.f;
+	EPhase Phase = EPhase::WaitingForClients;
+	float PhaseTime = 0;
+	float TimeSinceLastSample = 0;
+	double WorldTickStartSeconds = 0;
+	TArray<double> FrameTimesMs;
+	TArray<FConnectionStats> Connections;
+	FDelegateHandle TickStartHandle;
+	FDelegateHandle TickFlushHandle;
+};
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "ClimbingSoakPlayerController.generated.h"
+
+class AIslandAdventureGameCharacter;
+
+/**
+ * Player controller handed out by AClimbingSoakGameMode. On the client it plays the character's own input actions
+ * (move, look, climb, climb dash, grapple) from a script instead of a player, so the soak test sends real client moves and RPCs.
+ *
+ * The script is seeded random play by default (-SoakSeed=N). A recorded script is used with -SoakScript=Path,
+ * one "Seconds,Action[,X,Y]" step per line, where Action is Move, Look, Climb, CancelClimb, ClimbDash or Grapple.
+ * Move and Look hold their value until the next step of the same kind, the script loops when it runs out.
+ */
+UCLASS()
+class ISLANDADVENTUREGAME_API AClimbingSoakPlayerController : public APlayerController
+{
+	GENERATED_BODY()
+
+public:
+	virtual void BeginPlay() override;
+	virtual void PlayerTick(float DeltaTime) override;
+
+private:
+	enum class ESoakAction : uint8
+	{
+		Move,
+		Look,
+		Climb,
+		CancelClimb,
+		ClimbDash,
+		Grapple
+	};
+
+	struct FSoakStep
+	{
+		float Seconds = 0;
+		ESoakAction Action = ESoakAction::Move;
+		FVector2D Value = FVector2D::ZeroVector;
+	};
+
+	bool LoadRecordedScript(const FString& Path);
+	void PlayRecordedScript(AIslandAdventureGameCharacter& Character, float DeltaTime);
+	void PlayRandomScript(AIslandAdventureGameCharacter& Character, float DeltaTime);
+	void RunAction(AIslandAdventureGameCharacter& Character, ESoakAction Action);
+
+	UPROPERTY(Category = "Soak", EditAnywhere)
+		float ClimbDashesPerSecond = 0.3f;
+	UPROPERTY(Category = "Soak", EditAnywhere)
+		float GrapplesPerSecond = 0.2f;
+	UPROPERTY(Category = "Soak", EditAnywhere)
+		float TurnsPerSecond = 0.25f;
+	//random play lets go of a wall after climbing for this long
+	UPROPERTY(Category = "Soak", EditAnywhere)
+		float MaxClimbSeconds = 12.f;
+
+	TArray<FSoakStep> RecordedSteps;
+	int32 NextStep = 0;
+	float ScriptTime = 0;
+	FVector2D MoveValue = FVector2D(0, 1);
+	FVector2D LookValue = FVector2D::ZeroVector;
+	float ClimbTime = 0;
+	FRandomStream Random;
+};
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Float frame centred on the wall the character is climbing. Everything the climbing solver does happens within a few metres
+ * of the wall, so it runs in single precision relative to this origin and only converts to world doubles at the edges.
+ */
+struct FClimbingLocalFrame
+{
+	FVector Origin = FVector::ZeroVector;
+
+	FClimbingLocalFrame() = default;
+	explicit FClimbingLocalFrame(const FVector& InOrigin) : Origin(InOrigin) {}
+
+	FORCEINLINE FVector3f ToLocal(const FVector& WorldPosition) const { return FVector3f(WorldPosition - Origin); }
+	FORCEINLINE FVector ToWorld(const FVector3f& LocalPosition) const { return Origin + FVector(LocalPosition); }
+};
+
+/**
+ * The climbing solver's kernels, written once for either precision. The movement component runs them in float around the wall,
+ * IslandAdventure.Climbing.BenchmarkSolverMath times both. No speedup has been measured, the float frame is there for precision far from the origin.
+ */
+namespace ClimbingSolverMath
+{
+	/** Unnormalised normal of the probe triangle ABC */
+	template<typename T>
+	FORCEINLINE UE::Math::TVector<T> TriangleNormal(const UE::Math::TVector<T>& A, const UE::Math::TVector<T>& B, const UE::Math::TVector<T>& C)
+	{
+		return UE::Math::TVector<T>::CrossProduct(B - A, C - A);
+	}
+
+	/**
+	 * What the four corner probes add to the wall normal: the normals of triangles ABC and ABD, unnormalised so bigger triangles count for more.
+	 * Each is turned to face the same side as Reference (the summed assist hit normals), so the order the corners come in doesn't matter
+	 */
+	template<typename T>
+	FORCEINLINE UE::Math::TVector<T> CornerProbeNormal(const UE::Math::TVector<T>& A, const UE::Math::TVector<T>& B, const UE::Math::TVector<T>& C, const UE::Math::TVector<T>& D, const UE::Math::TVector<T>& Reference)
+	{
+		const UE::Math::TVector<T> NormalABC = TriangleNormal(A, B, C);
+		const UE::Math::TVector<T> NormalABD = TriangleNormal(A, B, D);
+		return ((NormalABC | Reference) < 0 ? -NormalABC : NormalABC) + ((NormalABD | Reference) < 0 ? -NormalABD : NormalABD);
+	}
+
+	/** Move that puts the character DistanceFromSurface in front of the wall, ToSurface runs from the character to the climbing position */
+	template<typename T>
+	FORCEINLINE UE::Math::TVector<T> SnapOffset(const UE::Math::TVector<T>& ToSurface, const UE::Math::TVector<T>& Forward, const UE::Math::TVector<T>& SurfaceNormal, T DistanceFromSurface)
+	{
+		const UE::Math::TVector<T> ForwardDifference = ToSurface.ProjectOnTo(Forward);
+		return -SurfaceNormal * (ForwardDifference.Length() - DistanceFromSurface);
+	}
+
+	/** Share of what is left that an exponential approach at Speed covers in DeltaTime, converges the same way whatever the step size */
+	template<typename T>
+	FORCEINLINE T ConvergenceAlpha(T Speed, T DeltaTime)
+	{
+		return T(1) - FMath::Exp(-Speed * DeltaTime);
+	}
+
+	/** Snap and rotation speed multiplier, so a climber moving faster than MaxSpeed (a dash) still keeps up with the wall */
+	template<typename T>
+	FORCEINLINE T SpeedScale(T Speed, T InvMaxSpeed)
+	{
+		return FMath::Max(T(1), Speed * InvMaxSpeed);
+	}
+
+	/** Rotation Alpha of the way from Current to facing the wall */
+	template<typename T>
+	FORCEINLINE UE::Math::TQuat<T> ClimbingRotation(const UE::Math::TQuat<T>& Current, const UE::Math::TVector<T>& SurfaceNormal, T Alpha)
+	{
+		const UE::Math::TQuat<T> Target = UE::Math::TRotationMatrix<T>::MakeFromX(-SurfaceNormal).ToQuat();
+		return UE::Math::TQuat<T>::Slerp(Current, Target, Alpha);
+	}
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "CollisionShape.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/HitResult.h"
+
+/**
+ * Per-character cache for the scene queries the movement probes make during a frame.
+ * Identical queries are answered from the cache, and a line trace that covers part of an earlier trace along the same ray
+ * is answered from that trace. Results are dropped whenever a new frame starts.
+ */
+class ISLANDADVENTUREGAME_API FEnvironmentQueryCache
+{
+public:
+	void Init(UWorld* InWorld, ECollisionChannel InChannel, const FCollisionQueryParams* InQueryParams);
+
+	bool LineTrace(FHitResult& OutHit, const FVector& Start, const FVector& End);
+	bool Sweep(FHitResult& OutHit, const FVector& Start, const FVector& End, const FQuat& Rotation, const FCollisionShape& Shape);
+	bool SweepMulti(TArray<FHitResult>& OutHits, const FVector& Start, const FVector& End, const FQuat& Rotation, const FCollisionShape& Shape);
+
+	/** Drops everything cached, for when the world changed under us mid-frame */
+	void Invalidate();
+
+	/** Queries that actually went to the physics scene */
+	FORCEINLINE uint32 GetNumQueriesIssued() const { return NumQueriesIssued; }
+	/** Queries answered from the cache */
+	FORCEINLINE uint32 GetNumCacheHits() const { return NumCacheHits; }
+
+private:
+	struct FCachedQuery
+	{
+		FVector Start;
+		FVector End;
+		FQuat Rotation;
+		FCollisionShape Shape;
+		bool bIsLineTrace = false;
+		bool bBlockingHit = false;
+		FHitResult Hit;
+	};
+
+	static constexpr int32 MaxCachedQueries = 16;
+
+	void BeginFrameIfNeeded();
+	const FCachedQuery* FindSweep(const FVector& Start, const FVector& End, const FQuat& Rotation, const FCollisionShape& Shape) const;
+	bool FindContainingLineTrace(const FVector& Start, const FVector& End, FHitResult& OutHit, bool& bOutBlockingHit) const;
+	void Store(const FCachedQuery& Query);
+	void RecordQuery(bool bCacheHit);
+
+	TWeakObjectPtr<UWorld> World;
+	ECollisionChannel Channel = ECC_WorldStatic;
+	const FCollisionQueryParams* QueryParams = nullptr;
+
+	TArray<FCachedQuery, TInlineAllocator<MaxCachedQueries>> CachedQueries;
+	int32 NextEvictIndex = 0;
+
+	//the last multi sweep, kept separately since it owns an array of hits
+	bool bHasCachedMulti = false;
+	bool bCachedMultiBlockingHit = false;
+	FVector CachedMultiStart;
+	FVector CachedMultiEnd;
+	FQuat CachedMultiRotation;
+	FCollisionShape CachedMultiShape;
+	TArray<FHitResult> CachedMultiHits;
+
+	uint64 CachedFrame = MAX_uint64;
+	uint32 NumQueriesIssued = 0;
+	uint32 NumCacheHits = 0;
+};
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "GrappleHistoryComponent.generated.h"
+
+/**
+ * Server-side transform history of a grapple-able mover. Every tick the owner's root transform is written into a fixed ring buffer
+ * so grapple requests can be checked against where the mover was when the client aimed, not where it is now.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class ISLANDADVENTUREGAME_API UGrappleHistoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:	
+	// Sets default values for this component's properties
+	UGrappleHistoryComponent();
+
+	/** The owner's root transform at a past server time, clamped to the oldest and newest recorded samples. False if nothing is recorded yet */
+	bool GetTransformAtTime(float Time, FTransform& OutTransform) const;
+
+	/** How far back the history reaches */
+	float GetHistoryDuration() const;
+
+	/** Drops the recorded history and stops or resumes recording, for owners parked in and taken out of the pawn pool */
+	void SetPooled(bool bPooled);
+
+protected:
+	virtual void BeginPlay() override;
+
+public:	
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	//kept small on purpose, a few hundred movers fit in a few hundred KB
+	struct FSample
+	{
+		FQuat4f Rotation;
+		FVector3f Location;
+		float Time;
+	};
+
+	bool ShouldRecord() const;
+	void Record();
+	const FSample& GetSample(int32 Age) const { return Samples[(Head - Age + HistorySize) % HistorySize]; }
+
+	//a bit over a second at 60Hz, well past any rewind the server accepts
+	static constexpr int32 HistorySize = 64;
+
+	FSample Samples[HistorySize];
+	//newest sample
+	int32 Head = INDEX_NONE;
+	int32 NumSamples = 0;
+};
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "IslandReplicationGraph.generated.h"
+
+class ACharacter;
+
+enum class EIslandClassRepNodeMapping : uint8
+{
+	//not placed in any node, handled elsewhere (per connection)
+	NotRouted,
+	RelevantAllConnections,
+	//placed in the grid once, never moves
+	Spatialize_Static,
+	//placed in the grid and re-gridded every frame
+	Spatialize_Dynamic,
+	//grid while awake, treated as static while dormant
+	Spatialize_Dormancy,
+};
+
+/**
+ * Replication graph for the island. Characters and other movers go in a 2D spatial grid sized for traversal speeds, so each connection
+ * only looks at the cells around its viewer instead of every actor in the world. Climbing characters replicate on their own, slower, frequency bucket.
+ *
+ * Enabled through ReplicationDriverClassName in DefaultEngine.ini.
+ */
+UCLASS(Transient, Config = Engine)
+class ISLANDADVENTUREGAME_API UIslandReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	virtual void ResetGameWorldState() override;
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+
+	/** Moves a character in or out of the climbing frequency bucket, does nothing when the net driver isn't using this graph */
+	static void SetClimbingReplication(ACharacter* Character, bool bIsClimbing);
+
+	//a cell is about how far a character sprints in a few seconds, small enough that a viewer only gathers a handful of cells
+	UPROPERTY(Config)
+		float GridCellSize = 10000.f;
+	//most negative corner of the island, everything past it is clamped into the edge cells
+	UPROPERTY(Config)
+		FVector2D GridSpatialBias = FVector2D(-200000.f, -200000.f);
+	//frames between replications of a climbing character, climbing is slow enough that half rate hides well behind smoothing
+	UPROPERTY(Config)
+		uint32 ClimbingReplicationPeriodFrame = 2;
+
+private:
+	EIslandClassRepNodeMapping GetMappingPolicy(const UClass* Class) const;
+	void SetClassPolicy(UClass* Class, EIslandClassRepNodeMapping Mapping);
+
+	TClassMap<EIslandClassRepNodeMapping> ClassRepNodePolicies;
+
+	UPROPERTY()
+		UReplicationGraphNode_GridSpatialization2D* GridNode;
+	UPROPERTY()
+		UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+};
@@ -4,9 +4,105 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/LowLevelMemTracker.h"
 #include "ActorAnchor.h"
+#include "EnvironmentQueryCache.h"
+#include "ClimbingProfile.h"
+#include "ClimbSurfaceWalker.h"
 #include "PlayerMovementComponent.generated.h"
 
+LLM_DECLARE_TAG(ClimbingMovement);
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnClimbingStateChanged, bool, bIsClimbing);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnClimbDashStateChanged, bool, bIsClimbDashing);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnGrappleTargetChanged, bool, bHasGrappleTarget, FVector, GrapplePoint, AActor*, GrappleTarget);
+
+class FSavedMove_PlayerMovement : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+
+	uint8 bSavedWantsToClimb : 1;
+	uint8 bSavedWantsToClimbDash : 1;
+	uint8 bSavedIsClimbDashing : 1;
+	float SavedClimbDashTime;
+	FVector SavedClimbDashDirection;
+};
+
+class FNetworkPredictionData_Client_PlayerMovement : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_PlayerMovement(const UCharacterMovementComponent& ClientMovement) : Super(ClientMovement) {}
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+/** Which part of the climbing probe sequence to run, the surface probes follow up on the wall hits */
+enum class EClimbingProbes : uint8
+{
+	//the capsule sweep into the wall, all a climb request needs
+	Wall,
+	//the assist and corner probes against wall hits that are already stored
+	Surface,
+	WallAndSurface
+};
+
+/** What the climbing probes found around the character */
+struct FClimbingProbeResult
+{
+	FVector Position = FVector::ZeroVector;
+	FVector Normal = FVector::ZeroVector;
+	int32 NumCornerContacts = 0;
+	//every hit the wall sweep reported, before the ones past MaxWallHits were dropped
+	int32 NumSweptWallHits = 0;
+};
+
+/** Sweeps for the wall before the character moves, so PhysClimbing works from this frame's hits. Only reads the scene, so it can run on any thread */
+USTRUCT()
+struct FPlayerMovementWallProbeTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UPlayerMovementComponent* Target = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FPlayerMovementWallProbeTickFunction> : public TStructOpsTypeTraitsBase2<FPlayerMovementWallProbeTickFunction>
+{
+	enum { WithCopy = false };
+};
+
+/** Looks for a grapple target once the camera has updated for the frame. Reads the camera and fires events, so it stays on the game thread */
+USTRUCT()
+struct FPlayerMovementGrappleTargetingTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UPlayerMovementComponent* Target = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FPlayerMovementGrappleTargetingTickFunction> : public TStructOpsTypeTraitsBase2<FPlayerMovementGrappleTargetingTickFunction>
+{
+	enum { WithCopy = false };
+};
+
 
 /**
  *
@@ -17,6 +113,8 @@ class ISLANDADVENTUREGAME_API UPlayerMovementComponent : public UCharacterMoveme
 	GENERATED_BODY()
 
 public:
+	UPlayerMovementComponent();
+
 	void TryClimbing();
 	void CancelClimbing();
 	UFUNCTION(BlueprintPure)
@@ -29,18 +127,77 @@ public:
 		bool IsClimbDashing() const { return IsClimbing() && bIsClimbDashing; }
 	UFUNCTION(BlueprintPure)
 		FVector GetClimbDashDirection() const { return ClimbDashDirection; }
+	//share of the corner probes that found the wall on the last surface probe, 1 on a flat wall
+	UFUNCTION(BlueprintPure)
+		float GetSurfaceProbeContactRatio() const { return (float)NumSurfaceProbeContacts / NumSurfaceProbes; }
 	UFUNCTION(BlueprintCallable)
 		void TryGrapple();
+	/** Swaps the climbing tuning, safe to call mid-climb */
+	UFUNCTION(BlueprintCallable)
+		void SetClimbingProfile(UClimbingProfile* NewProfile);
+	/** Drops climbing, dash, grapple and anchor state, for characters going back into the pawn pool */
+	void ResetClimbingState();
+	FORCEINLINE const UClimbingProfile& GetClimbingProfile() const { return ClimbingProfile ? *ClimbingProfile : *GetDefault<UClimbingProfile>(); }
+
+	/**
+	 * The climbing probe sequence for a character at Location facing along Rotation: the wall sweep into InOutWallHits, an assist sweep towards each wall hit
+	 * and the corner probes from CornerProbeStarts. The climbing tick and the offline cost audit both run their probes through here.
+	 * Only reads the scene, so it is safe off the game thread as long as DebugContext is null.
+	 */
+	static void RunClimbingProbes(FEnvironmentQueryCache& Queries, const UClimbingProfile& Profile, const FVector& Location, const FQuat& Rotation, TConstArrayView<FVector> CornerProbeStarts,
+		EClimbingProbes Probes, TArray<FHitResult>& InOutWallHits, FClimbingProbeResult& OutResult, const UObject* DebugContext = nullptr);
+	/** The scene components the corner probes start from, the last NumSurfaceProbes children of the capsule */
+	static void GetCornerProbeComponents(const ACharacter& Character, TArray<USceneComponent*>& OutComponents);
+
+	/** Scene queries issued by the climbing and grapple probes since this component was created */
+	FORCEINLINE uint32 GetNumSceneQueries() const { return QueryCache.GetNumQueriesIssued(); }
+	/** Probe queries that were answered by the per-frame query cache instead of the physics scene */
+	FORCEINLINE uint32 GetNumCachedSceneQueries() const { return QueryCache.GetNumCacheHits(); }
+	/** Position corrections the server has sent this character's owning client, only counted on the server */
+	FORCEINLINE uint32 GetNumClientCorrections() const { return NumClientCorrections; }
+
+	//bind to these instead of polling the getters above every frame
+	/** Fired when the character starts or stops climbing */
+	UPROPERTY(BlueprintAssignable, Category = "Character Movement: Climbing")
+		FOnClimbingStateChanged OnClimbingStateChanged;
+	/** Fired when a climb dash starts and when it ends */
+	UPROPERTY(BlueprintAssignable, Category = "Character Movement: Climbing")
+		FOnClimbDashStateChanged OnClimbDashStateChanged;
+	/** Fired when a grapple target is found, lost, or swapped for a different actor. Only locally controlled characters look for targets */
+	UPROPERTY(BlueprintAssignable, Category = "Character Movement: Grappling")
+		FOnGrappleTargetChanged OnGrappleTargetChanged;
+
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	virtual void SendClientAdjustment() override;
+	virtual void SetComponentTickEnabled(bool bEnabled) override;
 
 private:
+	friend class FSavedMove_PlayerMovement;
+	friend struct FPlayerMovementWallProbeTickFunction;
+	friend struct FPlayerMovementGrappleTargetingTickFunction;
+#if WITH_DEV_AUTOMATION_TESTS
+	//drives the climbing tick directly to check it stays off the heap
+	friend class FClimbingSteadyStateAllocationTest;
+#endif
+
+	virtual void PostLoad() override;
 	virtual void BeginPlay() override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void RegisterComponentTickFunctions(bool bRegister) override;
+	virtual void OnUnregister() override;
 	virtual void OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity) override;
 	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
 	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
 	virtual float GetMaxSpeed() const override;
 	virtual float GetMaxAcceleration() const override;
 
+	//tick stages around the movement tick, see RegisterComponentTickFunctions
+	void TickWallProbe();
+	void TickGrappleTargeting();
+	UFUNCTION()
+		void OnControllerChanged(APawn* Pawn, AController* OldController, AController* NewController);
+
 	//TODO:Put all of these into a state
 	//Climbing Functions
 	void SweepAndStoreWallHits();
@@ -49,8 +206,18 @@ private:
 	bool IsFacingSurface(const float Steepness) const;
 	bool IsClimbableSurface(const FVector WallNormal) const;
 	void PhysClimbing(float deltaTime, int32 Iterations);
+	float GetClimbingSimulationTimeStep(float RemainingTime, int32 Iterations) const;
+	bool ClimbingSubstep(float timeTick, float RemainingTime, int32 Iterations);
+	class UClimbingAsyncSubsystem* GetAsyncClimbing() const;
+	void PhysClimbingAsync(float deltaTime, int32 Iterations, class UClimbingAsyncSubsystem& AsyncClimbing);
+	void ReleaseAsyncClimbingSlot();
 	void ComputeSurfaceInfo();
-	void GetAverageSurfaceNormals(const TArray<FVector>& Normals);
+	void RunClimbingProbes(EClimbingProbes Probes);
+	void UpdateClimbingAnchor();
+	bool TryReuseBaseRelativeSurface();
+	bool TryWalkClimbingSurface();
+	void TryAttachSurfaceWalker();
+	void UpdateClimbingBase();
 	void ComputeClimbingVelocity(float deltaTime);
 	bool ShouldStopClimbing();
 	void StopClimbing(float deltaTime, int32 Iterations);
@@ -70,40 +237,64 @@ private:
 
 	//Grapple Functions
 	void CheckForGrapplePoint();
+	bool FindGrapplePoint();
+	void SpawnAnchor();
+	bool IsValidGrappleRequest(const FVector& GrapplePoint, const AActor* GrappleTarget, float ClientTimeStamp) const;
+	bool IsValidRewoundGrappleRequest(const FVector& GrapplePoint, const class UGrappleHistoryComponent& TargetHistory, float RewindTime) const;
+	//the client only sends the quantized point it aimed at and the server time it aimed at it, the server checks it with a single ray before spawning the anchor
+	UFUNCTION(Server, Reliable)
+		void ServerRequestGrapple(FVector_NetQuantize GrapplePoint, AActor* GrappleTarget, float ClientTimeStamp);
+	//drops the client's local anchor when the server turns the grapple down
+	UFUNCTION(Client, Reliable)
+		void ClientGrappleRejected();
+
+	//every probe goes through these so repeated queries within a frame are served from the cache
+	bool ClimbingLineTrace(FHitResult& OutHit, const FVector& Start, const FVector& End) const;
+	bool ClimbingSweep(FHitResult& OutHit, const FVector& Start, const FVector& End, const FQuat& Rotation, const FCollisionShape& Shape) const;
+	bool ShouldDrawDebug() const;
+	void MigrateDeprecatedClimbingTuning();
+#if !UE_BUILD_SHIPPING
+	void VerifyNoScratchReallocation();
+#endif
 
 	//climbing variables
+	//tuning shared by every character of this archetype, characters without a profile use the UClimbingProfile defaults
 	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere)
-		int CollisionCapsuleRadius = 50;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere)
-		int CollisionCapsuleHalfHeight = 72;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere, meta = (ClampMin = "1.0", ClampMax = "75.0"))
-		float MinSurfaceNormalAngle = 25;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "180.0"))
-		float MinClimbingAngle = 70;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "180.0"))
-		float MaxClimbingAngle = 120;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "80.0"))
-		float ClimbingCollisionShrinkAmount = 30;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "300.0"))
-		float MaxClimbingSpeed = 120;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "500.0"))
-		float MaxClimbingAcceleration = 500;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "600.0"))
-		float ClimbingDeceleration = 600;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere, meta = (ClampMin = "1.0", ClampMax = "20.0"))
-		float ClimbingRotationSpeed = 6;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "60.0"))
-		float ClimbingSnapSpeed = 4;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "80.0"))
-		float DistanceFromSurface = 45;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere, meta = (ClampMin = "1.0", ClampMax = "500.0"))
-		float FloorCheckDistance = 100;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "80.0"))
-		float MinClimbDownThreshold = 40;
-	UPROPERTY(Category = "Character Movement: Climbing", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "80.0"))
-		float MinClimbLedgeThreshold = 20;	
-	UPROPERTY(Category = "Character Movement: Climbing", EditDefaultsOnly)
-		UCurveFloat* ClimbDashCurve;
+		UClimbingProfile* ClimbingProfile;
+
+	//the tuning that lived on the component before UClimbingProfile, still loaded so saved overrides can be moved into a profile by MigrateDeprecatedClimbingTuning
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		int CollisionCapsuleRadius_DEPRECATED = 50;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		int CollisionCapsuleHalfHeight_DEPRECATED = 72;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		float MinSurfaceNormalAngle_DEPRECATED = 25;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		float MinClimbingAngle_DEPRECATED = 70;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		float MaxClimbingAngle_DEPRECATED = 120;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		float ClimbingCollisionShrinkAmount_DEPRECATED = 30;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		float MaxClimbingSpeed_DEPRECATED = 120;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		float MaxClimbingAcceleration_DEPRECATED = 500;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		float ClimbingDeceleration_DEPRECATED = 600;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		float ClimbingRotationSpeed_DEPRECATED = 6;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		float ClimbingSnapSpeed_DEPRECATED = 4;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		float DistanceFromSurface_DEPRECATED = 45;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		float FloorCheckDistance_DEPRECATED = 100;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		float MinClimbDownThreshold_DEPRECATED = 40;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		float MinClimbLedgeThreshold_DEPRECATED = 20;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set this on the ClimbingProfile instead"))
+		UCurveFloat* ClimbDashCurve_DEPRECATED = nullptr;
 
 	//Grapple Variables
 	UPROPERTY(Category = "Character Movement: Grappling", EditAnywhere)
@@ -112,9 +303,41 @@ private:
 		float MaxGrappleAssistRadius = 1;
 	UPROPERTY(Category = "Character Movement: Grappling", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "3.0"))
 		float GrappleAssistPrecision = 1;
+	//How far the server accepts a client's grapple point from its own validation ray, covers quantization and the assist radius
+	UPROPERTY(Category = "Character Movement: Grappling", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "500.0"))
+		float GrappleValidationTolerance = 50;
+	//Longest camera boom the server allows for when checking how far away a client's grapple point is
+	UPROPERTY(Category = "Character Movement: Grappling", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "2000.0"))
+		float MaxGrappleCameraDistance = 600;
+	//Furthest back in time the server rewinds grapple targets with a UGrappleHistoryComponent, older claims are checked at this age
+	UPROPERTY(Category = "Character Movement: Grappling", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "1.0"))
+		float MaxGrappleRewindTime = 0.25f;
+	//How far behind the server's clock clients render replicated grapple targets, taken off the time sent with a grapple request
+	UPROPERTY(Category = "Character Movement: Grappling", EditAnywhere, meta = (ClampMin = "0.0", ClampMax = "0.5"))
+		float GrappleTargetInterpolationDelay = 0.1f;
 	UPROPERTY(Category = "Character Movement: Grappling", EditDefaultsOnly)
 		TSubclassOf<AActorAnchor> Anchor;
 
+	//wall sweeps past this many hits are truncated so the per-tick storage stays bounded
+	static constexpr int32 MaxWallHits = 8;
+	//the wall sweep starts this far in front of the character and runs this much further
+	static constexpr float WallSweepStartOffset = 30;
+	static constexpr float WallSweepLength = 50;
+	//every wall hit is followed up by a sphere sweep of this size and reach from the character
+	static constexpr float SurfaceAssistRadius = 10;
+	static constexpr float SurfaceAssistDistance = 120;
+	//the four corner probes used to build the surface triangles, each a sphere sweep of this size and reach along the character's forward
+	static constexpr int32 NumSurfaceProbes = 4;
+	static constexpr float CornerProbeRadius = 10;
+	static constexpr float CornerProbeLength = 100;
+	//the grapple ray starts this far in front of the camera so it skips over the character
+	static constexpr float GrappleRaycastStartOffset = 600;
+	//the probed climbing position has to be this close to a collision triangle for the walker to attach
+	static constexpr float SurfaceWalkAttachDistance = 20;
+	//how far from where a walk gave up we have to climb before walking that mesh again
+	static constexpr float SurfaceWalkReattachDistance = 50;
+
+	//filled in place every tick, capacity is reserved on BeginPlay and never shrinks
 	TArray<FHitResult> CurrentWallHits;
 	TArray<USceneComponent*> RaycastLocations;
 	FCollisionQueryParams ClimbingQueryParameters;
@@ -122,6 +345,31 @@ private:
 	FVector CurrentClimbingNormal;
 	FVector CurrentClimbingPosition;
 	FVector LastEdgeLocation;
+	int32 NumSurfaceProbeContacts = 0;
+	//the probe stage already worked out the surface for this frame's first climbing update
+	bool bSurfaceProbedThisFrame = false;
+	//the movable wall held on the last base update and where it was then, to catch walls moved without a velocity
+	TWeakObjectPtr<const UPrimitiveComponent> LastClimbedWall;
+	FTransform LastClimbedWallTransform;
+	//the surface in the space of the movement base, valid while climbing on SurfaceCacheBase
+	TWeakObjectPtr<const UPrimitiveComponent> SurfaceCacheBase;
+	bool bHasBaseRelativeSurface = false;
+	//follows the wall's collision triangles while mesh walking, detached whenever we fall back to probing
+	FClimbSurfaceWalker SurfaceWalker;
+	FVector LastSurfaceWalkLocation;
+	//the last mesh the walker couldn't attach to, not retried until we grab something else
+	TWeakObjectPtr<const UPrimitiveComponent> RejectedSurfaceWalkComponent;
+	//where the last walk gave up, the mesh isn't walked again until we have climbed away from that spot
+	TWeakObjectPtr<const UPrimitiveComponent> DetachedSurfaceWalkComponent;
+	FVector SurfaceWalkDetachLocation;
+	//slot in UClimbingAsyncSubsystem while climbing on the async physics tick
+	int32 AsyncClimbingSlot = INDEX_NONE;
+	uint32 AsyncResyncSequence = 0;
+	uint32 AsyncDashSequence = 0;
+	FVector LocalClimbingNormal;
+	FVector LocalClimbingPosition;
+	FVector LocalProbeLocation;
+	FVector LocalProbeForward;
 	float LedgeTraceDistance = 0;
 	FVector ClimbDashDirection;
 	bool bWantsToClimbDash = false;
@@ -130,6 +378,23 @@ private:
 
 	bool bCanGrapple = false;
 	FVector LastValidGrapplePoint;
-	AActor* ActorToGrapple;
-	AActorAnchor* CurrentAnchor;
+	AActor* ActorToGrapple = nullptr;
+	//anchors can break or retract on their own, so this has to be cleared when they go away
+	UPROPERTY(Transient)
+		AActorAnchor* CurrentAnchor = nullptr;
+
+	//the wall probe runs in TG_PrePhysics ahead of the movement tick, grapple targeting in TG_PostUpdateWork after the camera
+	UPROPERTY()
+		FPlayerMovementWallProbeTickFunction WallProbeTick;
+	UPROPERTY()
+		FPlayerMovementGrappleTargetingTickFunction GrappleTargetingTick;
+	TWeakObjectPtr<class APlayerCameraManager> GrappleCameraManager;
+
+	//shared by the climbing, ledge and grapple probes, cleared every frame
+	mutable FEnvironmentQueryCache QueryCache;
+	uint32 NumClientCorrections = 0;
+
+#if !UE_BUILD_SHIPPING
+	SIZE_T SteadyStateWallHitsSize = 0;
+#endif
 };
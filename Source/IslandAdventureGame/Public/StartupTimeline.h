@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogStartupTimeline, Log, All);
+
+enum class EStartupMilestone : uint8
+{
+	MapLoaded,
+	PawnPossessed,
+	FirstInputAccepted,
+	Num
+};
+
+/**
+ * Records the time from process start to each startup milestone, once per process.
+ * When the last milestone is reached the timeline is written to the log and appended to Saved/Profiling/StartupTimeline.csv
+ */
+class ISLANDADVENTUREGAME_API FStartupTimeline
+{
+public:
+	static void Mark(EStartupMilestone Milestone);
+
+private:
+	static void Flush();
+
+	static double MilestoneSeconds[(uint8)EStartupMilestone::Num];
+	static bool bFlushed;
+};
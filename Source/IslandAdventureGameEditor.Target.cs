@@ -11,5 +11,6 @@ public class IslandAdventureGameEditorTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V5;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_4;
 		ExtraModuleNames.Add("IslandAdventureGame");
+		ExtraModuleNames.Add("IslandAdventureGameEditor");
 	}
 }
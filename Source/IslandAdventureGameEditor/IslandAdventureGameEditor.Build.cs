@@ -0,0 +1,15 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class IslandAdventureGameEditor : ModuleRules
+{
+	public IslandAdventureGameEditor(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "IslandAdventureGame" });
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "AssetRegistry", "EngineSettings", "UnrealEd" });
+	}
+}
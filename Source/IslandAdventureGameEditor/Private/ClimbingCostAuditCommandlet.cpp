@@ -0,0 +1,450 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ClimbingCostAuditCommandlet.h"
+#include "Algo/Count.h"
+#include "Async/ParallelFor.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Level.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameMapsSettings.h"
+#include "HAL/PlatformTime.h"
+#include "IslandAdventureGameGameMode.h"
+#include "ClimbingProfile.h"
+#include "PlayerMovementComponent.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "WorldPartition/WorldPartition.h"
+#include "WorldPartition/WorldPartitionEditorLoaderAdapter.h"
+#include "WorldPartition/LoaderAdapter/LoaderAdapterShape.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogClimbingCostAudit, Log, All);
+
+namespace ClimbingCostAudit
+{
+	//a character hangs off a wall facing into it, so look for walls along the four horizontal axes from every cell
+	static const FVector SampleDirections[] = { FVector::ForwardVector, FVector::BackwardVector, FVector::RightVector, FVector::LeftVector };
+
+	static const UPrimitiveComponent* FindMostHitComponent(const TArray<FHitResult>& Hits)
+	{
+		const UPrimitiveComponent* MostHitComponent = nullptr;
+		int32 MostHits = 0;
+		for (const FHitResult& Hit : Hits)
+		{
+			const UPrimitiveComponent* Component = Hit.GetComponent();
+			const int32 NumHits = Algo::CountIf(Hits, [Component](const FHitResult& Other) { return Other.GetComponent() == Component; });
+			if (NumHits > MostHits)
+			{
+				MostHitComponent = Component;
+				MostHits = NumHits;
+			}
+		}
+		return MostHitComponent;
+	}
+
+	//instanced foliage and scattered props share one mesh, so costs are grouped by the asset rather than the component
+	static FString GetMeshName(const UPrimitiveComponent* Component)
+	{
+		const UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(Component);
+		if (StaticMeshComponent && StaticMeshComponent->GetStaticMesh())
+		{
+			return StaticMeshComponent->GetStaticMesh()->GetPathName();
+		}
+		return Component ? FString::Printf(TEXT("%s:%s"), *Component->GetClass()->GetName(), *GetNameSafe(Component->GetOwner())) : TEXT("None");
+	}
+
+	static FString GetActorLabel(const UPrimitiveComponent* Component)
+	{
+		return Component && Component->GetOwner() ? Component->GetOwner()->GetActorLabel() : TEXT("None");
+	}
+
+	static double ToMicroseconds(double Seconds)
+	{
+		return Seconds * 1000000.0;
+	}
+
+	//hotspots are timed again this many times one at a time, keeping the fastest run
+	static constexpr int32 NumHotspotTimings = 5;
+
+	//one climbing probe at a spot as if it were a frame of its own, returns how long it took
+	static double ProbeSpot(FEnvironmentQueryCache& Queries, const UClimbingProfile& Profile, TConstArrayView<FVector> CornerProbeOffsets, const FVector& Location, const FQuat& Rotation,
+		TArray<FVector>& CornerProbeStarts, TArray<FHitResult>& WallHits, FClimbingProbeResult& ProbeResult)
+	{
+		CornerProbeStarts.Reset();
+		for (const FVector& Offset : CornerProbeOffsets)
+		{
+			CornerProbeStarts.Add(Location + Rotation.RotateVector(Offset));
+		}
+
+		//nothing carries over from the spot before it
+		Queries.Invalidate();
+		const double StartTime = FPlatformTime::Seconds();
+		UPlayerMovementComponent::RunClimbingProbes(Queries, Profile, Location, Rotation, CornerProbeStarts, EClimbingProbes::WallAndSurface, WallHits, ProbeResult);
+		return FPlatformTime::Seconds() - StartTime;
+	}
+}
+
+UClimbingCostAuditCommandlet::UClimbingCostAuditCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UClimbingCostAuditCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+	const FString* MapParam = ParamVals.Find(TEXT("Map"));
+	const FString MapName = MapParam ? *MapParam : FSoftObjectPath(UGameMapsSettings::GetGameDefaultMap()).GetLongPackageName();
+	const FString* SpacingParam = ParamVals.Find(TEXT("Spacing"));
+	const float Spacing = SpacingParam ? FMath::Max(FCString::Atof(**SpacingParam), 25.f) : 200.f;
+	const FString* TopParam = ParamVals.Find(TEXT("Top"));
+	const int32 NumTop = TopParam ? FMath::Max(FCString::Atoi(**TopParam), 1) : 100;
+	const FString* OutDirParam = ParamVals.Find(TEXT("OutDir"));
+	const FString OutDir = OutDirParam ? *OutDirParam : FPaths::ProjectSavedDir() / TEXT("Audit");
+
+	//measure with the character the player actually climbs with, its tuning can be swapped for another profile
+	UClass* PawnClass = GetDefault<AIslandAdventureGameGameMode>()->GetDefaultPawnSoftClass().LoadSynchronous();
+	const UClimbingProfile* Profile = GetDefault<UClimbingProfile>();
+	if (const FString* ProfileParam = ParamVals.Find(TEXT("Profile")))
+	{
+		Profile = LoadObject<UClimbingProfile>(nullptr, **ProfileParam);
+		if (!Profile)
+		{
+			UE_LOG(LogClimbingCostAudit, Error, TEXT("Failed to load climbing profile %s"), **ProfileParam);
+			return 1;
+		}
+	}
+	else if (PawnClass)
+	{
+		const ACharacter* Character = Cast<ACharacter>(PawnClass->GetDefaultObject());
+		const UPlayerMovementComponent* Movement = Character ? Cast<UPlayerMovementComponent>(Character->GetCharacterMovement()) : nullptr;
+		if (Movement)
+		{
+			Profile = &Movement->GetClimbingProfile();
+		}
+	}
+
+	UWorld* World = LoadWorld(MapName);
+	if (!World)
+	{
+		UE_LOG(LogClimbingCostAudit, Error, TEXT("Failed to load map %s"), *MapName);
+		return 1;
+	}
+
+	const FBox Bounds = GetCollisionBounds(*World);
+	if (!Bounds.IsValid)
+	{
+		UE_LOG(LogClimbingCostAudit, Error, TEXT("%s has no collision to climb on"), *MapName);
+		return 1;
+	}
+
+	const TArray<FVector> CornerProbeOffsets = GetCornerProbeOffsets(*World, PawnClass);
+	if (CornerProbeOffsets.IsEmpty())
+	{
+		UE_LOG(LogClimbingCostAudit, Warning, TEXT("%s has no corner probe points, the samples leave out the corner probes"), *GetNameSafe(PawnClass));
+	}
+
+	TArray<FSample> Samples = SampleWorld(*World, *Profile, CornerProbeOffsets, Bounds, Spacing);
+	RetimeHotspots(*World, *Profile, CornerProbeOffsets, Samples, NumTop);
+
+	double TotalSeconds = 0;
+	double WorstSeconds = 0;
+	for (const FSample& Sample : Samples)
+	{
+		TotalSeconds += Sample.Seconds;
+		WorstSeconds = FMath::Max(WorstSeconds, Sample.Seconds);
+	}
+	UE_LOG(LogClimbingCostAudit, Display, TEXT("Probed %d climbable spots on %s with %s, mean %.1fus, worst %.1fus"),
+		Samples.Num(), *MapName, *GetNameSafe(Profile),
+		ClimbingCostAudit::ToMicroseconds(Samples.IsEmpty() ? 0 : TotalSeconds / Samples.Num()), ClimbingCostAudit::ToMicroseconds(WorstSeconds));
+
+	WriteHeatmap(OutDir, Samples);
+	WriteHotspots(OutDir, Samples, NumTop);
+	WriteMeshes(OutDir, Samples, NumTop);
+
+	World->RemoveFromRoot();
+	World->DestroyWorld(false);
+	return 0;
+}
+
+UWorld* UClimbingCostAuditCommandlet::LoadWorld(const FString& MapName) const
+{
+	UPackage* MapPackage = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+	if (!World)
+		return nullptr;
+
+	World->AddToRoot();
+	World->WorldType = EWorldType::Editor;
+	if (!World->bIsWorldInitialized)
+	{
+		//only the collision scene is needed, nothing simulates
+		World->InitWorld(UWorld::InitializationValues()
+			.RequiresHitProxies(false)
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(true)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.AllowAudioPlayback(false)
+			.CreatePhysicsScene(true));
+	}
+	World->UpdateWorldComponents(true, false);
+
+	//the audit covers the whole map, not just what streams in around the player start
+	for (ULevelStreaming* StreamingLevel : World->GetStreamingLevels())
+	{
+		StreamingLevel->SetShouldBeLoaded(true);
+		StreamingLevel->SetShouldBeVisible(true);
+	}
+	World->FlushLevelStreaming(EFlushLevelStreamingType::Full);
+
+	if (UWorldPartition* WorldPartition = World->GetWorldPartition())
+	{
+		const FBox WorldBounds(FVector(-HALF_WORLD_MAX), FVector(HALF_WORLD_MAX));
+		UWorldPartitionEditorLoaderAdapter* LoaderAdapter = WorldPartition->CreateEditorLoaderAdapter<FLoaderAdapterShape>(World, WorldBounds, TEXT("Climbing Cost Audit"));
+		LoaderAdapter->GetLoaderAdapter()->Load();
+	}
+
+	return World;
+}
+
+FBox UClimbingCostAuditCommandlet::GetCollisionBounds(const UWorld& World) const
+{
+	FBox Bounds(ForceInit);
+	for (const ULevel* Level : World.GetLevels())
+	{
+		for (const AActor* Actor : Level->Actors)
+		{
+			if (!Actor)
+				continue;
+
+			Actor->ForEachComponent<UPrimitiveComponent>(false, [&Bounds](const UPrimitiveComponent* Primitive)
+			{
+				//only what the climbing probes can hit
+				if (Primitive->IsRegistered() && Primitive->IsCollisionEnabled() && Primitive->GetCollisionResponseToChannel(ECC_WorldStatic) == ECR_Block)
+				{
+					Bounds += Primitive->Bounds.GetBox();
+				}
+			});
+		}
+	}
+	return Bounds;
+}
+
+TArray<FVector> UClimbingCostAuditCommandlet::GetCornerProbeOffsets(UWorld& World, UClass* PawnClass) const
+{
+	TArray<FVector> Offsets;
+	if (!PawnClass || !PawnClass->IsChildOf<ACharacter>())
+		return Offsets;
+
+	//the corner probe points are added on the blueprint, so spawn the character once to see where they sit
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParameters.ObjectFlags = RF_Transient;
+	ACharacter* Character = World.SpawnActor<ACharacter>(PawnClass, FTransform::Identity, SpawnParameters);
+	if (!Character)
+		return Offsets;
+
+	TArray<USceneComponent*> CornerProbes;
+	UPlayerMovementComponent::GetCornerProbeComponents(*Character, CornerProbes);
+	for (const USceneComponent* CornerProbe : CornerProbes)
+	{
+		Offsets.Add(Character->GetActorTransform().InverseTransformPositionNoScale(CornerProbe->GetComponentLocation()));
+	}
+
+	//gone again before sampling so the probes never hit it
+	World.DestroyActor(Character);
+	return Offsets;
+}
+
+TArray<UClimbingCostAuditCommandlet::FSample> UClimbingCostAuditCommandlet::SampleWorld(UWorld& World, const UClimbingProfile& Profile, TConstArrayView<FVector> CornerProbeOffsets, const FBox& Bounds, float Spacing) const
+{
+	const FVector BoundsSize = Bounds.GetSize();
+	const int32 NumCellsX = FMath::Max(1, FMath::CeilToInt32(BoundsSize.X / Spacing));
+	const int32 NumCellsY = FMath::Max(1, FMath::CeilToInt32(BoundsSize.Y / Spacing));
+	const int32 NumCellsZ = FMath::Max(1, FMath::CeilToInt32(BoundsSize.Z / Spacing));
+	UE_LOG(LogClimbingCostAudit, Display, TEXT("Sampling %d x %d x %d cells of %.0fcm on %d worker threads"),
+		NumCellsX, NumCellsY, NumCellsZ, Spacing, FTaskGraphInterface::Get().GetNumWorkerThreads());
+
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ClimbingCostAudit), false);
+
+	//one vertical column of cells per task, every column fills its own array so the workers share nothing but the scene
+	//the timings are taken with every core busy, so they rank spots against each other rather than against a frame budget,
+	//and the worst of them are timed again one at a time before they are reported as hotspots
+	TArray<TArray<FSample>> Columns;
+	Columns.SetNum(NumCellsX * NumCellsY);
+	ParallelFor(Columns.Num(), [&](int32 ColumnIndex)
+	{
+		TArray<FSample>& ColumnSamples = Columns[ColumnIndex];
+		TArray<FHitResult> WallHits;
+		TArray<FVector> CornerProbeStarts;
+		FClimbingProbeResult ProbeResult;
+		//each column probes through its own cache like each character does, so the samples pay for the same queries the tick makes
+		FEnvironmentQueryCache Queries;
+		Queries.Init(&World, ECC_WorldStatic, &QueryParams);
+		const int32 CellX = ColumnIndex % NumCellsX;
+		const int32 CellY = ColumnIndex / NumCellsX;
+		for (int32 CellZ = 0; CellZ < NumCellsZ; CellZ++)
+		{
+			const FVector CellCenter = Bounds.Min + FVector(CellX + 0.5, CellY + 0.5, CellZ + 0.5) * Spacing;
+			for (const FVector& Direction : ClimbingCostAudit::SampleDirections)
+			{
+				FHitResult WallHit;
+				if (!World.LineTraceSingleByChannel(WallHit, CellCenter, CellCenter + Direction * Spacing, ECC_WorldStatic, QueryParams) || WallHit.bStartPenetrating)
+					continue;
+
+				//same test as IsClimbableSurface
+				const float WallDotProduct = FVector::DotProduct(FVector::UpVector, WallHit.ImpactNormal);
+				if (WallDotProduct >= Profile.CosMinClimbingAngle || WallDotProduct <= Profile.CosMaxClimbingAngle)
+					continue;
+
+				FSample& Sample = ColumnSamples.AddDefaulted_GetRef();
+				Sample.WallNormal = WallHit.ImpactNormal;
+				Sample.Location = WallHit.ImpactPoint + WallHit.ImpactNormal * Profile.DistanceFromSurface;
+				Sample.Rotation = FRotationMatrix::MakeFromX(-WallHit.ImpactNormal).ToQuat();
+
+				const uint32 NumQueriesBefore = Queries.GetNumQueriesIssued();
+				Sample.Seconds = ClimbingCostAudit::ProbeSpot(Queries, Profile, CornerProbeOffsets, Sample.Location, Sample.Rotation, CornerProbeStarts, WallHits, ProbeResult);
+				Sample.NumQueries = Queries.GetNumQueriesIssued() - NumQueriesBefore;
+				Sample.NumWallHits = ProbeResult.NumSweptWallHits;
+				Sample.Component = ClimbingCostAudit::FindMostHitComponent(WallHits);
+			}
+		}
+	});
+
+	TArray<FSample> Samples;
+	for (TArray<FSample>& Column : Columns)
+	{
+		Samples.Append(MoveTemp(Column));
+	}
+	return Samples;
+}
+
+void UClimbingCostAuditCommandlet::RetimeHotspots(UWorld& World, const UClimbingProfile& Profile, TConstArrayView<FVector> CornerProbeOffsets, TArray<FSample>& Samples, int32 NumTop) const
+{
+	TArray<int32> ParallelRanking;
+	ParallelRanking.Reserve(Samples.Num());
+	for (int32 Index = 0; Index < Samples.Num(); Index++)
+	{
+		ParallelRanking.Add(Index);
+	}
+	ParallelRanking.Sort([&Samples](int32 A, int32 B) { return Samples[A].Seconds > Samples[B].Seconds; });
+
+	//twice as many candidates as hotspots, so a spot that only lost out to scheduling noise can still make the list
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ClimbingCostAudit), false);
+	FEnvironmentQueryCache Queries;
+	Queries.Init(&World, ECC_WorldStatic, &QueryParams);
+	TArray<FHitResult> WallHits;
+	TArray<FVector> CornerProbeStarts;
+	FClimbingProbeResult ProbeResult;
+	const int32 NumCandidates = FMath::Min(NumTop * 2, ParallelRanking.Num());
+	for (int32 Rank = 0; Rank < NumCandidates; Rank++)
+	{
+		FSample& Sample = Samples[ParallelRanking[Rank]];
+		Sample.RetimedSeconds = MAX_dbl;
+		for (int32 Timing = 0; Timing < ClimbingCostAudit::NumHotspotTimings; Timing++)
+		{
+			Sample.RetimedSeconds = FMath::Min(Sample.RetimedSeconds,
+				ClimbingCostAudit::ProbeSpot(Queries, Profile, CornerProbeOffsets, Sample.Location, Sample.Rotation, CornerProbeStarts, WallHits, ProbeResult));
+		}
+	}
+
+	//how much of the parallel ranking survives being timed on a quiet core
+	TArray<int32> RetimedRanking(ParallelRanking.GetData(), NumCandidates);
+	RetimedRanking.Sort([&Samples](int32 A, int32 B) { return Samples[A].RetimedSeconds > Samples[B].RetimedSeconds; });
+	const int32 NumHotspots = FMath::Min(NumTop, NumCandidates);
+	int32 NumAgreeing = 0;
+	for (int32 Rank = 0; Rank < NumHotspots; Rank++)
+	{
+		NumAgreeing += RetimedRanking.Find(ParallelRanking[Rank]) < NumHotspots ? 1 : 0;
+	}
+	UE_LOG(LogClimbingCostAudit, Display, TEXT("%d of the %d worst spots timed on every core are still among the %d worst timed one at a time"),
+		NumAgreeing, NumHotspots, NumHotspots);
+}
+
+void UClimbingCostAuditCommandlet::WriteHeatmap(const FString& OutDir, const TArray<FSample>& Samples) const
+{
+	FString Csv = TEXT("X,Y,Z,NormalX,NormalY,NormalZ,Queries,WallHits,Microseconds") LINE_TERMINATOR;
+	for (const FSample& Sample : Samples)
+	{
+		Csv += FString::Printf(TEXT("%.0f,%.0f,%.0f,%.3f,%.3f,%.3f,%d,%d,%.2f") LINE_TERMINATOR,
+			Sample.Location.X, Sample.Location.Y, Sample.Location.Z, Sample.WallNormal.X, Sample.WallNormal.Y, Sample.WallNormal.Z,
+			Sample.NumQueries, Sample.NumWallHits, ClimbingCostAudit::ToMicroseconds(Sample.Seconds));
+	}
+
+	const FString HeatmapPath = OutDir / TEXT("ClimbingCostAudit_Heatmap.csv");
+	FFileHelper::SaveStringToFile(Csv, *HeatmapPath);
+	UE_LOG(LogClimbingCostAudit, Display, TEXT("Wrote %d samples to %s"), Samples.Num(), *HeatmapPath);
+}
+
+void UClimbingCostAuditCommandlet::WriteHotspots(const FString& OutDir, const TArray<FSample>& Samples, int32 NumTop) const
+{
+	//ranked by the single threaded timings, only the candidates RetimeHotspots picked have one
+	TArray<const FSample*> Ranked;
+	for (const FSample& Sample : Samples)
+	{
+		if (Sample.RetimedSeconds >= 0)
+		{
+			Ranked.Add(&Sample);
+		}
+	}
+	Ranked.Sort([](const FSample& A, const FSample& B) { return A.RetimedSeconds > B.RetimedSeconds; });
+
+	FString Csv = TEXT("Rank,X,Y,Z,Queries,WallHits,Microseconds,ParallelMicroseconds,Actor,Mesh") LINE_TERMINATOR;
+	for (int32 Rank = 0; Rank < FMath::Min(NumTop, Ranked.Num()); Rank++)
+	{
+		const FSample& Sample = *Ranked[Rank];
+		Csv += FString::Printf(TEXT("%d,%.0f,%.0f,%.0f,%d,%d,%.2f,%.2f,%s,%s") LINE_TERMINATOR,
+			Rank + 1, Sample.Location.X, Sample.Location.Y, Sample.Location.Z, Sample.NumQueries, Sample.NumWallHits,
+			ClimbingCostAudit::ToMicroseconds(Sample.RetimedSeconds), ClimbingCostAudit::ToMicroseconds(Sample.Seconds),
+			*ClimbingCostAudit::GetActorLabel(Sample.Component), *ClimbingCostAudit::GetMeshName(Sample.Component));
+	}
+
+	const FString HotspotsPath = OutDir / TEXT("ClimbingCostAudit_Hotspots.csv");
+	FFileHelper::SaveStringToFile(Csv, *HotspotsPath);
+	UE_LOG(LogClimbingCostAudit, Display, TEXT("Wrote the %d most expensive spots to %s"), FMath::Min(NumTop, Ranked.Num()), *HotspotsPath);
+}
+
+void UClimbingCostAuditCommandlet::WriteMeshes(const FString& OutDir, const TArray<FSample>& Samples, int32 NumTop) const
+{
+	TMap<FString, FMeshCost> CostsByMesh;
+	for (const FSample& Sample : Samples)
+	{
+		const FString MeshName = ClimbingCostAudit::GetMeshName(Sample.Component);
+		FMeshCost& Cost = CostsByMesh.FindOrAdd(MeshName);
+		Cost.MeshName = MeshName;
+		Cost.NumSamples++;
+		Cost.TotalSeconds += Sample.Seconds;
+		Cost.WorstSeconds = FMath::Max(Cost.WorstSeconds, Sample.Seconds);
+		Cost.TotalWallHits += Sample.NumWallHits;
+		Cost.MaxWallHits = FMath::Max(Cost.MaxWallHits, Sample.NumWallHits);
+	}
+
+	//a mesh used everywhere costs more in total than one bad rock, which is what matters for the frame
+	TArray<FMeshCost> Meshes;
+	CostsByMesh.GenerateValueArray(Meshes);
+	Meshes.Sort([](const FMeshCost& A, const FMeshCost& B) { return A.TotalSeconds > B.TotalSeconds; });
+
+	FString Csv = TEXT("Rank,Mesh,Samples,TotalMicroseconds,MeanMicroseconds,WorstMicroseconds,MeanWallHits,MaxWallHits") LINE_TERMINATOR;
+	for (int32 Rank = 0; Rank < FMath::Min(NumTop, Meshes.Num()); Rank++)
+	{
+		const FMeshCost& Cost = Meshes[Rank];
+		Csv += FString::Printf(TEXT("%d,%s,%d,%.2f,%.2f,%.2f,%.2f,%d") LINE_TERMINATOR,
+			Rank + 1, *Cost.MeshName, Cost.NumSamples, ClimbingCostAudit::ToMicroseconds(Cost.TotalSeconds),
+			ClimbingCostAudit::ToMicroseconds(Cost.TotalSeconds / Cost.NumSamples), ClimbingCostAudit::ToMicroseconds(Cost.WorstSeconds),
+			(float)Cost.TotalWallHits / Cost.NumSamples, Cost.MaxWallHits);
+	}
+
+	const FString MeshesPath = OutDir / TEXT("ClimbingCostAudit_Meshes.csv");
+	FFileHelper::SaveStringToFile(Csv, *MeshesPath);
+	UE_LOG(LogClimbingCostAudit, Display, TEXT("Wrote the %d most expensive meshes to %s"), FMath::Min(NumTop, Meshes.Num()), *MeshesPath);
+}
@@ -0,0 +1,365 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PackagingAuditCommandlet.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameMapsSettings.h"
+#include "GameFramework/Pawn.h"
+#include "IslandAdventureGameGameMode.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPackagingAudit, Log, All);
+
+namespace PackagingAudit
+{
+	static const FString GameRoot = TEXT("/Game");
+
+	//world partition keeps actors and their objects in packages that nothing references directly
+	static bool IsExternalPackagePath(const FString& Path)
+	{
+		return Path.Contains(TEXT("/__ExternalActors__")) || Path.Contains(TEXT("/__ExternalObjects__"));
+	}
+
+	static FString ToMegabytes(int64 Bytes)
+	{
+		return FString::Printf(TEXT("%.2f MB"), Bytes / (1024.0 * 1024.0));
+	}
+}
+
+UPackagingAuditCommandlet::UPackagingAuditCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UPackagingAuditCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+	const bool bMeasureMemory = Switches.Contains(TEXT("MemorySizes"));
+	const FString* OutDirParam = ParamVals.Find(TEXT("OutDir"));
+	const FString OutDir = OutDirParam ? *OutDirParam : FPaths::ProjectSavedDir() / TEXT("Audit");
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	const TArray<FName> RootPackages = GatherRootPackages(AssetRegistry, ParamVals);
+	if (RootPackages.IsEmpty())
+	{
+		UE_LOG(LogPackagingAudit, Error, TEXT("No entry map or default pawn found, nothing to walk from"));
+		return 1;
+	}
+
+	const TSet<FName> ReachablePackages = GatherReachablePackages(AssetRegistry, RootPackages);
+
+	FARFilter Filter;
+	Filter.PackagePaths.Add(*PackagingAudit::GameRoot);
+	Filter.bRecursivePaths = true;
+	Filter.bIncludeOnlyOnDiskAssets = true;
+	TArray<FAssetData> GameAssets;
+	AssetRegistry.GetAssets(Filter, GameAssets);
+
+	TMap<FName, FPackageInfo> PackagesByName;
+	int32 NumMeasured = 0;
+	for (const FAssetData& Asset : GameAssets)
+	{
+		if (PackagesByName.Contains(Asset.PackageName) || PackagingAudit::IsExternalPackagePath(Asset.PackagePath.ToString()))
+			continue;
+
+		FPackageInfo& Info = PackagesByName.Add(Asset.PackageName);
+		Info.PackageName = Asset.PackageName;
+		Info.AssetName = Asset.AssetName;
+		Info.AssetClass = Asset.AssetClassPath;
+		Info.bReachable = ReachablePackages.Contains(Asset.PackageName);
+
+		if (const TOptional<FAssetPackageData> PackageData = AssetRegistry.GetAssetPackageDataCopy(Asset.PackageName))
+		{
+			Info.DiskSize = PackageData->DiskSize;
+		}
+
+		//loading everything is slow, so in-memory sizes are opt in
+		if (bMeasureMemory)
+		{
+			if (UObject* LoadedAsset = Asset.GetAsset())
+			{
+				Info.MemorySize = LoadedAsset->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+			}
+			if (++NumMeasured % 100 == 0)
+			{
+				CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+			}
+		}
+	}
+
+	TArray<FPackageInfo> Packages;
+	PackagesByName.GenerateValueArray(Packages);
+	Packages.Sort([](const FPackageInfo& A, const FPackageInfo& B) { return A.DiskSize > B.DiskSize; });
+
+	int64 ReachableBytes = 0;
+	int64 UnreferencedBytes = 0;
+	int32 NumUnreferenced = 0;
+	for (const FPackageInfo& Info : Packages)
+	{
+		if (Info.bReachable)
+		{
+			ReachableBytes += Info.DiskSize;
+		}
+		else
+		{
+			UnreferencedBytes += Info.DiskSize;
+			NumUnreferenced++;
+		}
+	}
+
+	UE_LOG(LogPackagingAudit, Display, TEXT("%d of %d /Game packages are reachable (%s), %d are unreferenced (%s)"),
+		Packages.Num() - NumUnreferenced, Packages.Num(), *PackagingAudit::ToMegabytes(ReachableBytes),
+		NumUnreferenced, *PackagingAudit::ToMegabytes(UnreferencedBytes));
+
+	WriteReport(OutDir, Packages);
+	WriteDuplicates(OutDir, Packages);
+	WriteCookRules(OutDir, RootPackages, Packages);
+
+	return 0;
+}
+
+TArray<FName> UPackagingAuditCommandlet::GatherRootPackages(IAssetRegistry& AssetRegistry, const TMap<FString, FString>& ParamVals) const
+{
+	TArray<FName> RootPackages;
+
+	const FString EntryMap = UGameMapsSettings::GetGameDefaultMap();
+	if (!EntryMap.IsEmpty())
+	{
+		const FName MapPackage = FSoftObjectPath(EntryMap).GetLongPackageFName();
+		RootPackages.Add(MapPackage);
+
+		const FString ExternalActorsPath = ULevel::GetExternalActorsPath(MapPackage.ToString());
+		FARFilter Filter;
+		Filter.PackagePaths.Add(*ExternalActorsPath);
+		Filter.PackagePaths.Add(*ExternalActorsPath.Replace(TEXT("/__ExternalActors__"), TEXT("/__ExternalObjects__")));
+		Filter.bRecursivePaths = true;
+		TArray<FAssetData> ExternalAssets;
+		AssetRegistry.GetAssets(Filter, ExternalAssets);
+		for (const FAssetData& Asset : ExternalAssets)
+		{
+			RootPackages.AddUnique(Asset.PackageName);
+		}
+	}
+
+	//the default pawn is only referenced by a soft class path in the game mode, so the map never pulls it in
+	const TSoftClassPtr<APawn> DefaultPawnClass = GetDefault<AIslandAdventureGameGameMode>()->GetDefaultPawnSoftClass();
+	if (!DefaultPawnClass.IsNull())
+	{
+		RootPackages.AddUnique(DefaultPawnClass.ToSoftObjectPath().GetLongPackageFName());
+	}
+
+	if (const FString* ExtraRoots = ParamVals.Find(TEXT("Roots")))
+	{
+		TArray<FString> ExtraRootNames;
+		ExtraRoots->ParseIntoArray(ExtraRootNames, TEXT(","), true);
+		for (const FString& ExtraRoot : ExtraRootNames)
+		{
+			RootPackages.AddUnique(FName(*ExtraRoot));
+		}
+	}
+
+	return RootPackages;
+}
+
+TSet<FName> UPackagingAuditCommandlet::GatherReachablePackages(IAssetRegistry& AssetRegistry, const TArray<FName>& RootPackages) const
+{
+	TSet<FName> Reachable;
+	TArray<FName> Pending = RootPackages;
+	TArray<FName> Dependencies;
+
+	//both hard and soft package references end up in the cook, so walk both
+	while (!Pending.IsEmpty())
+	{
+		const FName PackageName = Pending.Pop(EAllowShrinking::No);
+		bool bAlreadyVisited = false;
+		Reachable.Add(PackageName, &bAlreadyVisited);
+		if (bAlreadyVisited)
+			continue;
+
+		Dependencies.Reset();
+		AssetRegistry.GetDependencies(PackageName, Dependencies, UE::AssetRegistry::EDependencyCategory::Package);
+		for (const FName Dependency : Dependencies)
+		{
+			if (!Reachable.Contains(Dependency))
+			{
+				Pending.Add(Dependency);
+			}
+		}
+	}
+
+	return Reachable;
+}
+
+void UPackagingAuditCommandlet::WriteReport(const FString& OutDir, const TArray<FPackageInfo>& Packages) const
+{
+	FString Csv = TEXT("Package,Class,Reachable,DiskBytes,MemoryBytes") LINE_TERMINATOR;
+	for (const FPackageInfo& Info : Packages)
+	{
+		Csv += FString::Printf(TEXT("%s,%s,%d,%lld,%lld") LINE_TERMINATOR, *Info.PackageName.ToString(), *Info.AssetClass.ToString(), Info.bReachable, Info.DiskSize, Info.MemorySize);
+	}
+
+	const FString ReportPath = OutDir / TEXT("PackagingAudit.csv");
+	FFileHelper::SaveStringToFile(Csv, *ReportPath);
+	UE_LOG(LogPackagingAudit, Display, TEXT("Wrote package report to %s"), *ReportPath);
+}
+
+void UPackagingAuditCommandlet::WriteDuplicates(const FString& OutDir, const TArray<FPackageInfo>& Packages) const
+{
+	//package bytes include their own path, so copies never hash the same. Same class plus same name or same size is a good enough signal
+	TMap<FString, TArray<const FPackageInfo*>> Groups;
+	for (const FPackageInfo& Info : Packages)
+	{
+		Groups.FindOrAdd(FString::Printf(TEXT("Name:%s:%s"), *Info.AssetClass.ToString(), *Info.AssetName.ToString())).Add(&Info);
+		if (Info.DiskSize > 0)
+		{
+			Groups.FindOrAdd(FString::Printf(TEXT("Size:%s:%lld"), *Info.AssetClass.ToString(), Info.DiskSize)).Add(&Info);
+		}
+	}
+
+	FString Csv = TEXT("Group,Package,Reachable,DiskBytes,MemoryBytes") LINE_TERMINATOR;
+	int64 DuplicateBytes = 0;
+	//a copy usually matches on both name and size, so only count each package's bytes once however many groups it is in
+	TSet<FName> CountedDuplicates;
+	for (const TPair<FString, TArray<const FPackageInfo*>>& Group : Groups)
+	{
+		if (Group.Value.Num() < 2)
+			continue;
+
+		for (int32 Index = 0; Index < Group.Value.Num(); Index++)
+		{
+			const FPackageInfo* Info = Group.Value[Index];
+			Csv += FString::Printf(TEXT("%s,%s,%d,%lld,%lld") LINE_TERMINATOR, *Group.Key, *Info->PackageName.ToString(), Info->bReachable, Info->DiskSize, Info->MemorySize);
+
+			//the first package of a group is kept as the original
+			bool bAlreadyCounted = false;
+			if (Index > 0 && !CountedDuplicates.Contains(Group.Value[0]->PackageName))
+			{
+				CountedDuplicates.Add(Info->PackageName, &bAlreadyCounted);
+				if (!bAlreadyCounted)
+				{
+					DuplicateBytes += Info->DiskSize;
+				}
+			}
+		}
+	}
+
+	const FString DuplicatesPath = OutDir / TEXT("PackagingAudit_Duplicates.csv");
+	FFileHelper::SaveStringToFile(Csv, *DuplicatesPath);
+	UE_LOG(LogPackagingAudit, Display, TEXT("Wrote duplicate candidates (%s) to %s"), *PackagingAudit::ToMegabytes(DuplicateBytes), *DuplicatesPath);
+}
+
+void UPackagingAuditCommandlet::WriteCookRules(const FString& OutDir, const TArray<FName>& RootPackages, const TArray<FPackageInfo>& Packages) const
+{
+	IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+
+	//a folder can only be skipped by the cook if nothing under it is reachable, and only be always cooked if everything under it is
+	TMap<FString, bool> FolderHasReachable;
+	TMap<FString, bool> FolderHasUnreachable;
+	for (const FPackageInfo& Info : Packages)
+	{
+		FString Folder = FPackageName::GetLongPackagePath(Info.PackageName.ToString());
+		while (Folder.StartsWith(PackagingAudit::GameRoot) && Folder != PackagingAudit::GameRoot)
+		{
+			bool& bHasReachable = FolderHasReachable.FindOrAdd(Folder, false);
+			bHasReachable |= Info.bReachable;
+			bool& bHasUnreachable = FolderHasUnreachable.FindOrAdd(Folder, false);
+			bHasUnreachable |= !Info.bReachable;
+			Folder = FPackageName::GetLongPackagePath(Folder);
+		}
+	}
+
+	TArray<FString> NeverCookFolders;
+	for (const TPair<FString, bool>& Folder : FolderHasReachable)
+	{
+		if (Folder.Value)
+			continue;
+
+		//only emit the shallowest unreferenced folder
+		const FString Parent = FPackageName::GetLongPackagePath(Folder.Key);
+		const bool* bParentHasReachable = FolderHasReachable.Find(Parent);
+		if (!bParentHasReachable || *bParentHasReachable)
+		{
+			NeverCookFolders.Add(Folder.Key);
+		}
+	}
+	NeverCookFolders.Sort();
+
+	FString Ini;
+	Ini += TEXT("; Generated by -run=PackagingAudit, merge into Config/DefaultGame.ini.") LINE_TERMINATOR;
+	Ini += TEXT("; Assets that are only loaded by a string path from code are invisible to this audit, pass them with -Roots.") LINE_TERMINATOR LINE_TERMINATOR;
+
+	FString AssetManagerRules = TEXT("[/Script/Engine.AssetManagerSettings]") LINE_TERMINATOR;
+	FString PackagingRules = TEXT("[/Script/UnrealEd.ProjectPackagingSettings]") LINE_TERMINATOR TEXT("bGenerateChunks=True") LINE_TERMINATOR;
+	TArray<FString> RootAssetPaths;
+	for (const FName RootPackage : RootPackages)
+	{
+		const FString RootPath = RootPackage.ToString();
+		if (!RootPath.StartsWith(PackagingAudit::GameRoot) || PackagingAudit::IsExternalPackagePath(RootPath))
+			continue;
+
+		TArray<FAssetData> RootAssets;
+		AssetRegistry.GetAssetsByPackageName(RootPackage, RootAssets);
+		const bool bIsMap = RootAssets.ContainsByPredicate([](const FAssetData& Asset) { return Asset.AssetClassPath == UWorld::StaticClass()->GetClassPathName(); });
+		if (bIsMap)
+		{
+			AssetManagerRules += FString::Printf(TEXT("+PrimaryAssetRules=(PrimaryAssetId=\"Map:%s\",Rules=(Priority=1,ChunkId=0,CookRule=AlwaysCook))") LINE_TERMINATOR, *RootPath);
+			PackagingRules += FString::Printf(TEXT("+MapsToCook=(FilePath=\"%s\")") LINE_TERMINATOR, *RootPath);
+		}
+		else if (!RootAssets.IsEmpty())
+		{
+			//cook just the root asset, a folder rule would drag every unreachable sibling into the build with it
+			const FAssetData* MainAsset = RootAssets.FindByPredicate([](const FAssetData& Asset) { return Asset.IsUAsset(); });
+			RootAssetPaths.Add((MainAsset ? *MainAsset : RootAssets[0]).GetSoftObjectPath().ToString());
+		}
+		else
+		{
+			//no asset to name, the folder is only safe to cook whole when nothing in it is unreachable
+			const FString RootFolder = FPackageName::GetLongPackagePath(RootPath);
+			const bool* bHasUnreachable = FolderHasUnreachable.Find(RootFolder);
+			if (bHasUnreachable && !*bHasUnreachable)
+			{
+				PackagingRules += FString::Printf(TEXT("+DirectoriesToAlwaysCook=(Path=\"%s\")") LINE_TERMINATOR, *RootFolder);
+			}
+			else
+			{
+				UE_LOG(LogPackagingAudit, Warning, TEXT("No cook rule written for root %s, it has no asset and %s holds unreachable content"), *RootPath, *RootFolder);
+			}
+		}
+	}
+	if (!RootAssetPaths.IsEmpty())
+	{
+		//the roots aren't primary assets of their own, so they get a type of their own that lists exactly them
+		TArray<FString> QuotedPaths;
+		for (const FString& AssetPath : RootAssetPaths)
+		{
+			QuotedPaths.Add(FString::Printf(TEXT("\"%s\""), *AssetPath));
+		}
+		AssetManagerRules += TEXT("bShouldManagerDetermineTypeAndName=True") LINE_TERMINATOR;
+		AssetManagerRules += FString::Printf(TEXT("+PrimaryAssetTypesToScan=(PrimaryAssetType=\"PackagingAuditRoot\",AssetBaseClass=\"/Script/CoreUObject.Object\",bHasBlueprintClasses=False,bIsEditorOnly=False,SpecificAssets=(%s),Rules=(Priority=1,ChunkId=0,CookRule=AlwaysCook))") LINE_TERMINATOR,
+			*FString::Join(QuotedPaths, TEXT(",")));
+	}
+	for (const FString& Folder : NeverCookFolders)
+	{
+		PackagingRules += FString::Printf(TEXT("+DirectoriesToNeverCook=(Path=\"%s\")") LINE_TERMINATOR, *Folder);
+	}
+
+	Ini += AssetManagerRules + LINE_TERMINATOR + PackagingRules;
+
+	const FString RulesPath = OutDir / TEXT("PackagingAudit_CookRules.ini");
+	FFileHelper::SaveStringToFile(Ini, *RulesPath);
+	UE_LOG(LogPackagingAudit, Display, TEXT("Wrote cook and chunk rules (%d folders never cooked) to %s"), NeverCookFolders.Num(), *RulesPath);
+}
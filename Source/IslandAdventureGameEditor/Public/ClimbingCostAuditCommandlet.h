@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ClimbingCostAuditCommandlet.generated.h"
+
+class UClimbingProfile;
+
+/**
+ * Loads a map, finds climbable wall spots on a grid across it and runs the climbing probe sequence at each one on every core.
+ * Writes a per-sample heatmap plus the worst spots and the meshes that cost the most, so cluttered surfaces can be fixed before they ship.
+ *
+ * Usage: UnrealEditor-Cmd IslandAdventureGame.uproject -run=ClimbingCostAudit [-Map=/Game/Maps/Map] [-Profile=/Game/Path/Profile] [-Spacing=200] [-Top=100] [-OutDir=Path]
+ */
+UCLASS()
+class UClimbingCostAuditCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UClimbingCostAuditCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	struct FSample
+	{
+		FVector Location;
+		FVector WallNormal;
+		FQuat Rotation;
+		//the component most of the wall hits landed on
+		const UPrimitiveComponent* Component = nullptr;
+		int32 NumQueries = 0;
+		int32 NumWallHits = 0;
+		double Seconds = 0;
+		//fastest of several single threaded timings, only for the hotspot candidates
+		double RetimedSeconds = -1;
+	};
+
+	struct FMeshCost
+	{
+		FString MeshName;
+		int32 NumSamples = 0;
+		double TotalSeconds = 0;
+		double WorstSeconds = 0;
+		int32 TotalWallHits = 0;
+		int32 MaxWallHits = 0;
+	};
+
+	UWorld* LoadWorld(const FString& MapName) const;
+	FBox GetCollisionBounds(const UWorld& World) const;
+	//where the default character's corner probes start, relative to its capsule
+	TArray<FVector> GetCornerProbeOffsets(UWorld& World, UClass* PawnClass) const;
+	TArray<FSample> SampleWorld(UWorld& World, const UClimbingProfile& Profile, TConstArrayView<FVector> CornerProbeOffsets, const FBox& Bounds, float Spacing) const;
+	void RetimeHotspots(UWorld& World, const UClimbingProfile& Profile, TConstArrayView<FVector> CornerProbeOffsets, TArray<FSample>& Samples, int32 NumTop) const;
+	void WriteHeatmap(const FString& OutDir, const TArray<FSample>& Samples) const;
+	void WriteHotspots(const FString& OutDir, const TArray<FSample>& Samples, int32 NumTop) const;
+	void WriteMeshes(const FString& OutDir, const TArray<FSample>& Samples, int32 NumTop) const;
+};
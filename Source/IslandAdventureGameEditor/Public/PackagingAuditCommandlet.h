@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PackagingAuditCommandlet.generated.h"
+
+class IAssetRegistry;
+
+/**
+ * Walks the asset registry from the game's entry map and default pawn and reports which /Game packages are never reached,
+ * which look like duplicates, and how big they are. Also writes the cook/chunk rules that limit the build to reachable content.
+ *
+ * Usage: UnrealEditor-Cmd IslandAdventureGame.uproject -run=PackagingAudit [-Roots=/Game/A,/Game/B] [-MemorySizes] [-OutDir=Path]
+ */
+UCLASS()
+class UPackagingAuditCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UPackagingAuditCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	struct FPackageInfo
+	{
+		FName PackageName;
+		FName AssetName;
+		FTopLevelAssetPath AssetClass;
+		int64 DiskSize = 0;
+		int64 MemorySize = 0;
+		bool bReachable = false;
+	};
+
+	TArray<FName> GatherRootPackages(IAssetRegistry& AssetRegistry, const TMap<FString, FString>& ParamVals) const;
+	TSet<FName> GatherReachablePackages(IAssetRegistry& AssetRegistry, const TArray<FName>& RootPackages) const;
+	void WriteReport(const FString& OutDir, const TArray<FPackageInfo>& Packages) const;
+	void WriteDuplicates(const FString& OutDir, const TArray<FPackageInfo>& Packages) const;
+	void WriteCookRules(const FString& OutDir, const TArray<FName>& RootPackages, const TArray<FPackageInfo>& Packages) const;
+};